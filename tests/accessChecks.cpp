@@ -0,0 +1,61 @@
+// Checks that the access checks follow the System whose work is running,
+// on the chunks of "parallelEach" and across Models.
+//
+//     g++ -std=c++20 -pthread -I.. accessChecks.cpp && ./a.out
+
+#define YOBECS_ACCESS_CHECKS 1
+#undef NDEBUG
+
+#include <cassert>
+#include <cstdio>
+#include <memory>
+
+#include "yobecs/ecs.hpp"
+
+using namespace yobtk::ecs;
+
+struct A
+{ int v = 0; };
+
+struct B
+{ int v = 0; };
+
+using Model_ = Model<256, A, B>;
+
+int main()
+{
+    // A single worker runs the System attached to B and, while it waits for
+    // its own chunks, helps with the chunks of the System attached to A.
+    Model_ m;
+    m.setJobSystem(std::make_shared<JobSystem>(1));
+    m.setParallel(m.defaultGroup());
+
+    for (int i = 0; i < 4096; i++)
+    {
+        auto e = m.createEntity();
+        m.insert<A>(e);
+        m.insert<B>(e);
+    }
+
+    m.createSystem<A>([](auto&, Model_& m) {
+        m.parallelEach<A>([&](auto e, A&) { m.access<A>(e).v++; }, 16);
+    });
+    m.createSystem<B>([](auto&, Model_& m) {
+        m.parallelEach<B>([](auto, B& b) { b.v++; }, 16);
+    });
+
+    for (int f = 0; f < 50; f++)
+    { m.process(0.1); }
+
+    // A System of a Model accessing another Model is not checked against
+    // the first Model's declarations.
+    m.setParallel(m.defaultGroup(), false);
+    Model_ other;
+    auto e = other.createEntity();
+    other.insert<B>(e);
+    m.createSystem<A>([&](auto&, Model_&) { other.access<B>(e).v++; });
+    m.process(0.1);
+    assert(other.read<B>(e).v == 1);
+
+    std::puts("ok");
+}
@@ -0,0 +1,77 @@
+// Checks the single node fallback of NUMA placement, used on systems
+// without NUMA support or when YOBECS_NUMA is set to 0.
+//
+//     g++ -std=c++20 -pthread -I.. numaFallback.cpp && ./a.out
+
+#define YOBECS_NUMA 0
+#undef NDEBUG
+
+#include <cassert>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "yobecs/ecs.hpp"
+
+using namespace yobtk::ecs;
+
+struct Position
+{ double x = 0.0; };
+
+struct Name
+{ std::string s; };
+
+using Model_ = Model<256, Position, Direct<Name>, Sparse<int>, Inline<char>>;
+
+int main()
+{
+    // The machine is seen as a single node.
+    assert(numa::nodeCount() == 1);
+    assert(numa::cpusOf(0).empty());
+
+    std::vector<char> buffer (numa::pageSize);
+    assert(numa::apply(buffer.data(), buffer.size(), Placement{}));
+    assert(!numa::apply(buffer.data(), buffer.size(), Placement::onNode(0)));
+    assert(!numa::apply(buffer.data(), buffer.size(), Placement::interleaved()));
+
+    // Placements are ignored, but existing data is still moved intact.
+    Model_ m;
+    std::vector<Model_::Entity> es;
+    for (int i = 0; i < 3000; i++)
+    {
+        auto e = m.createEntity();
+        es.push_back(e);
+        m.insert<Position>(e, { double(i) });
+        m.insert<Name>(e, { std::to_string(i) });
+        if (i % 10 == 0)
+        { m.insert<int>(e, i); }
+        m.insert<char>(e, 'a');
+    }
+
+    m.setPlacement(Placement::onNode(0, true));
+    m.setPlacement<Position>(Placement::interleaved());
+    for (int i = 0; i < 3000; i++)
+    {
+        assert(m.read<Position>(es[i]).x == i);
+        assert(m.read<Name>(es[i]).s == std::to_string(i));
+        assert(m.read<char>(es[i]) == 'a');
+        if (i % 10 == 0)
+        { assert(m.read<int>(es[i]) == i); }
+    }
+
+    // Workers cannot be pinned, and stay on node 0.
+    WorldSet<Model_> worlds (std::make_shared<JobSystem>(2));
+    assert(!worlds.jobs().pinWorkers());
+    for (std::size_t w = 0; w < worlds.jobs().workerCount(); w++)
+    { assert(worlds.jobs().workerNode(w) == 0); }
+
+    auto h = worlds.create(0);
+    auto frames = 0;
+    (*h)->createSystem<Position>([&](auto&, Model_&) { frames++; });
+    (*h)->insert<Position>((*h)->createEntity());
+    worlds.process(0.1);
+    assert(frames == 1);
+
+    std::puts("ok");
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * \brief Enables the verification of Component accesses made by Systems
+ *        against their declared read and write sets. Defaults to enabled
+ *        unless NDEBUG is defined; when disabled, the checks and their
+ *        bookkeeping are compiled away.
+ */
+#ifndef YOBECS_ACCESS_CHECKS
+#ifdef NDEBUG
+#define YOBECS_ACCESS_CHECKS 0
+#else
+#define YOBECS_ACCESS_CHECKS 1
+#endif
+#endif
+
+/**
+ * \brief Reports a misuse that would break the Model and aborts, in every
+ *        build. Meant for cheap checks outside of hot loops.
+ */
+#define YOBECS_ENSURE(cond, msg)                                                   \
+    do                                                                             \
+    {                                                                              \
+        if (!(cond))                                                               \
+        {                                                                          \
+            std::fprintf(stderr, "yobecs: %s (%s:%d)\n", msg, __FILE__, __LINE__); \
+            std::abort();                                                          \
+        }                                                                          \
+    } while (false)
+
+/**
+ * \brief Reports a failed access check and aborts. Unlike assert, it follows
+ *        YOBECS_ACCESS_CHECKS rather than NDEBUG, so that checks can be
+ *        enabled in optimised builds.
+ */
+#if YOBECS_ACCESS_CHECKS
+#define YOBECS_CHECK(cond, msg) YOBECS_ENSURE(cond, msg)
+#else
+#define YOBECS_CHECK(cond, msg) ((void) 0)
+#endif
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Marks a Component's type as only read by a System, when used in the
+ *        types a System is attached to or allowed to access.
+ * 
+ * \param T The Component's type.
+ */
+template <typename T>
+struct Read {};
+
+template <typename T>
+struct _bareType
+{ using type = T; };
+
+template <typename T>
+struct _bareType<Read<T>>
+{ using type = T; };
+
+/**
+ * \brief The Component's type of T, with any Read marker removed.
+ */
+template <typename T>
+using BareType = typename _bareType<T>::type;
+
+/**
+ * \brief Checks if T is marked as only read.
+ */
+template <typename T>
+static constexpr bool isRead = false;
+
+template <typename T>
+static constexpr bool isRead<Read<T>> = true;
+
+}
\ No newline at end of file
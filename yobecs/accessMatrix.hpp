@@ -1,33 +1,127 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <compare>
 #include <vector>
 #include <memory>
 #include <deque>
 #include <limits>
+#include <set>
+#include <utility>
+
+#include "numa.hpp"
+#include "signature.hpp"
+
+/**
+ * \brief Orders Entities by slot number instead of address, so that the
+ *        ordered sets of Entities, and thus iteration, follow the same order
+ *        on every machine given the same sequence of operations. Defaults to
+ *        disabled, as comparisons then read the rows.
+ */
+#ifndef YOBECS_DETERMINISTIC
+#define YOBECS_DETERMINISTIC 0
+#endif
 
 namespace yobtk::ecs {
 
+/**
+ * \brief Which released Index of an AccessMatrix is reused first.
+ */
+enum class Reuse
+{
+    /**
+     * \brief The last one released, still warm in cache. Default policy.
+     */
+    Lifo,
+
+    /**
+     * \brief The first one released, so that a released Index ages as long
+     *        as possible before being reused.
+     */
+    Fifo,
+
+    /**
+     * \brief The one with the lowest slot number, which keeps the Indices in
+     *        use packed at the beginning of the first Blocks. Creation can be
+     *        hinted to stay in the Block of a given Index.
+     */
+    Lowest
+};
+
 /**
  * \brief Represents a matrix of access points (only offsets in tables for the moment).
- *        It uses a vector of unique pointers to Blocks where Blocks are fixed size arrays of
- *        access points.
+ *        It uses a vector of unique pointers to Blocks where Blocks are arrays of
+ *        access points that are never moved nor resized. Blocks grow geometrically:
+ *        each new Block is as large as every previous one together, up to a limit,
+ *        unless a larger Block is reserved explicitly.
  * 
- * \param N Size of a block.
+ * \param N Size of the first block.
  * \param M Number of access points per element.
+ * \param P Number of presence bits per element (its signature).
+ * \param I Number of bytes of inline data per element.
  */
-template <std::size_t N, std::size_t M>
+template <std::size_t N, std::size_t M, std::size_t P = M, std::size_t I = 0>
 class AccessMatrix
 {
+public:
+    /**
+     * \brief Presence bits of an element.
+     */
+    using Signature = ecs::Signature<P>;
+
 private:
-    using Accessors_ = std::array<std::size_t, M>;
-    using Block_     = std::array<Accessors_, N>;
+    struct Row_
+    {
+        std::array<std::size_t, M> accessors;
+        Signature signature;
+        alignas(std::size_t) std::array<std::byte, I> inlineData;
+        std::size_t slot;
+    };
 
 public:
+#if YOBECS_DETERMINISTIC
+    /**
+     * \brief Represents a pointer to the data stored, ordered by slot number.
+     */
+    class Index
+    {
+    public:
+        Index() = default;
+
+        Index(Row_* row)
+        : row_ { row }
+        {}
+
+        Row_& operator*() const
+        { return *row_; }
+
+        Row_* operator->() const
+        { return row_; }
+
+        explicit operator bool() const
+        { return row_ != nullptr; }
+
+        bool operator==(const Index& o) const
+        { return row_ == o.row_; }
+
+        std::strong_ordering operator<=>(const Index& o) const
+        {
+            if (!row_ || !o.row_)
+            { return std::compare_three_way{}(row_, o.row_); }
+
+            return row_->slot <=> o.row_->slot;
+        }
+
+    private:
+        Row_* row_ = nullptr;
+    };
+#else
     /**
      * \brief Represents a pointer to the data stored.
      */
-    using Index = typename Block_::iterator;
+    using Index = Row_*;
+#endif
 
     /**
      * \brief Retrieves the p-th access point at Index i.
@@ -38,18 +132,28 @@ public:
      * \return A reference to the access point's value.
      */
     auto& get(Index i, std::size_t p)
-    { return (*i)[p]; }
+    { return i->accessors[p]; }
 
     /**
-     * \brief Check if the Index i has the p-th access point.
+     * \brief Check if the Index i has the b-th presence bit.
      * 
      * \param i The index of interest.
-     * \param p The access point number.
+     * \param b The presence bit number.
      * 
      * \return A boolean answering the check.
      */
-    auto has(Index i, std::size_t p)
-    { return get(i, p) != maxAccessor_; }
+    auto has(Index i, std::size_t b)
+    { return i->signature[b]; }
+
+    /**
+     * \brief Sets or clears the b-th presence bit of Index i.
+     * 
+     * \param i The index of interest.
+     * \param b The presence bit number.
+     * \param v The new value of the bit.
+     */
+    void mark(Index i, std::size_t b, bool v)
+    { i->signature.set(b, v); }
 
     /**
      * \brief Resets the p-th access point of Index i to the default value.
@@ -60,18 +164,204 @@ public:
     void reset(Index i, std::size_t p)
     { get(i, p) = maxAccessor_; }
 
+    /**
+     * \brief Gets the presence bits of Index i.
+     * 
+     * \param i The index of interest.
+     * 
+     * \return The presence bits.
+     */
+    const auto& signature(Index i)
+    { return i->signature; }
+
+    /**
+     * \brief Retrieves the inline data of Index i at a given byte offset.
+     * 
+     * \param i   The index of interest.
+     * \param off The byte offset.
+     * 
+     * \return A pointer to the inline data.
+     */
+    std::byte* inlineData(Index i, std::size_t off)
+    { return i->inlineData.data() + off; }
+
+    /**
+     * \brief Gets the slot number of Index i, unique among the Indices of
+     *        the matrix and stable until its destruction.
+     * 
+     * \param i The index of interest.
+     * 
+     * \return The slot number.
+     */
+    std::size_t slot(Index i)
+    { return i->slot; }
+
+    /**
+     * \brief Retrieves the Index of a slot number.
+     * 
+     * \param s The slot number. Must be lower than "capacity()".
+     * 
+     * \return The Index.
+     */
+    Index at(std::size_t s)
+    {
+        auto& b = blockOf_(s);
+        return b.rows.get() + (s - b.first);
+    }
+
+    /**
+     * \brief Gets the number of slots, in use or not.
+     * 
+     * \return The number of slots.
+     */
+    std::size_t capacity() const
+    { return capacity_; }
+
+    /**
+     * \brief Calls f on the Index of every slot in [first, last), in use or
+     *        not, walking the Blocks in order.
+     * 
+     * \param first The first slot.
+     * \param last  The slot past the last one, at most "capacity()".
+     * \param f     Function called on each Index: (Index) -> void
+     */
+    template <typename F>
+    void forEach(std::size_t first, std::size_t last, F&& f)
+    {
+        while (first < last)
+        {
+            auto& b = blockOf_(first);
+            auto end = std::min(last, b.first + b.rows.get_deleter().size);
+            for (auto r = b.rows.get() + (first - b.first); first < end; first++, r++)
+            { f(Index(r)); }
+        }
+    }
+
+    /**
+     * \brief Makes sure that n Indices can be created without allocating,
+     *        by allocating a single Block for the missing ones. Released
+     *        Indices count and are handed out following the reuse policy.
+     * 
+     * \param n The number of Indices.
+     */
+    void reserve(std::size_t n)
+    {
+        if (n > availableCount_())
+        { expand_(n - availableCount_()); }
+    }
+
+    /**
+     * \brief Changes which released Index is reused first.
+     * 
+     * \param r The reuse policy.
+     */
+    void reuse(Reuse r)
+    {
+        if (r == reuse_)
+        { return; }
+
+        std::vector<std::size_t> slots (lowest_.begin(), lowest_.end());
+        for (auto it = available_.rbegin(); it < available_.rend(); it++)
+        { slots.push_back((*it)->slot); }
+        std::sort(slots.begin(), slots.end());
+
+        available_.clear();
+        lowest_.clear();
+        reuse_ = r;
+        for (auto s : slots)
+        { release_(at(s), true); }
+    }
+
+    /**
+     * \brief Finds the next move packing the Indices in use: the one with the
+     *        highest slot number goes to the free one with the lowest slot
+     *        number. Blocks left entirely free at the end are released first.
+     *        Only valid with the Lowest policy.
+     * 
+     * \return The Index to move and its destination, or null Indices if the
+     *         Indices in use are already packed.
+     */
+    std::pair<Index, Index> nextMove()
+    {
+        auto end = std::min(tail_, capacity_);
+        for (auto it = std::make_reverse_iterator(lowest_.lower_bound(end)); it != lowest_.rend() && *it == end - 1; it++)
+        { end--; }
+        tail_ = end;
+
+        while (data_.size() > 1 && data_.back().first >= end)
+        {
+            capacity_ = data_.back().first;
+            lowest_.erase(lowest_.lower_bound(capacity_), lowest_.end());
+            data_.pop_back();
+        }
+
+        if (lowest_.empty() || *lowest_.begin() >= end)
+        { return { nullptr, nullptr }; }
+
+        return { at(end - 1), at(*lowest_.begin()) };
+    }
+
+    /**
+     * \brief Moves the content of Index from to the free Index to, then
+     *        releases from. Only valid with the Lowest policy.
+     * 
+     * \param from The Index moved.
+     * \param to   The destination, given by "nextMove".
+     */
+    void relocate(Index from, Index to)
+    {
+        auto s = to->slot;
+        lowest_.erase(s);
+        *to = *from;
+        to->slot = s;
+        free(from);
+    }
+
+    /**
+     * \brief Makes the Blocks follow a placement, moving the existing ones
+     *        when possible.
+     * 
+     * \param p The placement.
+     */
+    void place(const Placement& p)
+    {
+        placement_ = p;
+        for (auto& b : data_)
+        { numa::apply(b.rows.get(), b.rows.get_deleter().size * sizeof(Row_), p); }
+    }
+
     /**
      * \brief Creates an Index.
      * 
+     * \param near An optional Index in use, whose Block is preferred when
+     *             following the Lowest policy.
+     * 
      * \return The newly created Index.
      */
-    Index make()
+    Index make(Index near = nullptr)
     {
-        if (available_.empty())
-        { expand_(); }
+        if (availableCount_() == 0)
+        { expand_(std::clamp(capacity_, N, std::max(N, maxGrowth_))); }
+
+        if (reuse_ == Reuse::Lowest)
+        {
+            auto it = lowest_.begin();
+            if (near)
+            {
+                auto n = lowest_.lower_bound(near->slot);
+                if (n != lowest_.end() && &blockOf_(*n) == &blockOf_(near->slot))
+                { it = n; }
+            }
+
+            auto i = at(*it);
+            lowest_.erase(it);
+            tail_ = std::max(tail_, i->slot + 1);
+            return i;
+        }
 
         auto i = available_.back();
         available_.pop_back();
+        tail_ = std::max(tail_, i->slot + 1);
         return i;
     }
 
@@ -82,27 +372,86 @@ public:
      */
     void free(Index i)
     {
-        *i = defaultAccessors_;
-        available_.push_back(i);
+        auto s = i->slot;
+        *i = defaultRow_;
+        i->slot = s;
+        release_(i, false);
     }
 
 private:
-    std::vector<std::unique_ptr<Block_>> data_;
+    // Blocks are allocated on whole pages, so that they can be placed.
+    struct RowsDeleter_
+    {
+        const Placement* placement;
+        std::size_t size;
+
+        void operator()(Row_* rows) const
+        {
+            std::destroy_n(rows, size);
+            PlacedAllocator<Row_>(placement).deallocate(rows, size);
+        }
+    };
+
+    struct Block_
+    {
+        std::unique_ptr<Row_[], RowsDeleter_> rows;
+        std::size_t first;
+    };
+
+    // Geometric growth stops at Blocks of this many rows.
+    static constexpr std::size_t maxGrowth_ = std::size_t(1) << 16;
+
+    Placement placement_;
+    std::vector<Block_> data_;
+    std::size_t capacity_ = 0;
+    Reuse reuse_ = Reuse::Lifo;
+
+    // Every slot from tail_ to the capacity is free.
+    std::size_t tail_ = 0;
+
+    // Available Indices, taken from the back, or their slots with the Lowest policy.
     std::deque<Index> available_;
+    std::set<std::size_t> lowest_;
 
     static constexpr auto maxAccessor_ = std::numeric_limits<std::size_t>::max();
-    static constexpr auto defaultAccessors_ = [](){
-        Accessors_ d;
-        d.fill(maxAccessor_);
+    static constexpr auto defaultRow_ = [](){
+        Row_ d {};
+        d.accessors.fill(maxAccessor_);
         return d;
     }();
 
-    void expand_()
+    void expand_(std::size_t n)
+    {
+        auto rows = PlacedAllocator<Row_>(&placement_).allocate(n);
+        std::uninitialized_fill_n(rows, n, defaultRow_);
+        data_.push_back({ { rows, RowsDeleter_ { &placement_, n } }, capacity_ });
+
+        for (auto it = rows; it < rows + n; it++)
+        {
+            it->slot = capacity_++;
+            release_(it, true);
+        }
+    }
+
+    // Fresh Indices are taken in increasing order, after the released ones.
+    void release_(Index i, bool fresh)
+    {
+        if (reuse_ == Reuse::Lowest)
+        { lowest_.insert(i->slot); }
+        else if (fresh || reuse_ == Reuse::Fifo)
+        { available_.push_front(i); }
+        else
+        { available_.push_back(i); }
+    }
+
+    std::size_t availableCount_() const
+    { return available_.size() + lowest_.size(); }
+
+    Block_& blockOf_(std::size_t s)
     {
-        auto& last = data_.emplace_back(std::make_unique<Block_>());
-        last->fill(defaultAccessors_);
-        for(auto it = last->begin(); it < last->end(); it++)
-        { available_.push_front(it); }
+        auto b = std::upper_bound(data_.begin(), data_.end(), s,
+                                  [](std::size_t s, const Block_& b) { return s < b.first; });
+        return b[-1];
     }
 };
 
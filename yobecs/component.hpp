@@ -1,11 +1,19 @@
 #pragma once
 
+#include <iterator>
+#include <utility>
 #include <vector>
 
+#include "numa.hpp"
+#include "valueIndex.hpp"
+
 namespace yobtk::ecs {
 
 /**
- * \brief Represents a Component. Groups data inside a contiguous vector.
+ * \brief Represents a Component. Groups data inside a contiguous vector,
+ *        along with the owners. Once asked by "keepSlots", the slot numbers
+ *        of the owners are kept as well, so that walking the data with the
+ *        ids of the owners reads contiguous arrays only.
  * 
  * \param T The type used.
  * \param E The Entity type, used to handle owners.
@@ -18,15 +26,54 @@ public:
      * \brief Inserts entity e to the component with value val.
      * 
      * \param e   The entity.
-     * \param val An optional default value.
+     * \param s   The slot of the entity, only kept after "keepSlots".
+     * \param val An optional default value, moved into the component.
      * 
      * \return The offset of the data inside the vector.
      */
-    auto insert(E e, const T& val = {})
+    auto insert(E e, std::size_t s, T val = {})
     {
         auto a = data_.size();
-        data_.push_back(val);
+        data_.push_back(std::move(val));
         owners_.push_back(e);
+        if (slotsKept_)
+        { slots_.push_back(s); }
+
+        if constexpr (Indexed<T>)
+        { index_.insert(Index_::key(data_[a]), e); }
+
+        return a;
+    }
+
+    /**
+     * \brief Inserts entities es to the component with values vals, in bulk.
+     * 
+     * \param es     The entities.
+     * \param vals   The values, moved into the component.
+     * \param slotOf Function giving the slot of an entity, only called
+     *               after "keepSlots": (E) -> std::size_t
+     * 
+     * \return The offset of the first data inside the vector. The data
+     *         of es[k] is at this offset plus k.
+     */
+    template <typename S>
+    auto insertMany(const std::vector<E>& es, std::vector<T>&& vals, S&& slotOf)
+    {
+        auto a = data_.size();
+        data_.insert(data_.end(), std::make_move_iterator(vals.begin()), std::make_move_iterator(vals.end()));
+        owners_.insert(owners_.end(), es.begin(), es.end());
+        if (slotsKept_)
+        {
+            for (auto& e : es)
+            { slots_.push_back(slotOf(e)); }
+        }
+
+        if constexpr (Indexed<T>)
+        {
+            for (auto k = a; k < data_.size(); k++)
+            { index_.insert(Index_::key(data_[k]), owners_[k]); }
+        }
+
         return a;
     }
 
@@ -39,11 +86,19 @@ public:
      */
     auto remove(std::size_t a)
     {
+        if constexpr (Indexed<T>)
+        { index_.erase(Index_::key(data_[a]), owners_[a]); }
+
         owners_[a] = owners_.back();
         auto e = owners_[a];
         owners_.resize(owners_.size() - 1);
+        if (slotsKept_)
+        {
+            slots_[a] = slots_.back();
+            slots_.resize(slots_.size() - 1);
+        }
         
-        data_[a] = data_.back();
+        data_[a] = std::move(data_.back());
         data_.resize(data_.size() - 1);
 
         return e;
@@ -59,9 +114,172 @@ public:
     auto& access(std::size_t a)
     { return data_[a]; }
 
+    /**
+     * \brief Gets the owner of the data at offset a.
+     * 
+     * \param a The offset.
+     * 
+     * \return The owner.
+     */
+    auto owner(std::size_t a) const
+    { return owners_[a]; }
+
+    /**
+     * \brief Gets the slot of the owner of the data at offset a. Only valid
+     *        after "keepSlots".
+     * 
+     * \param a The offset.
+     * 
+     * \return The slot.
+     */
+    auto slot(std::size_t a) const
+    { return slots_[a]; }
+
+    /**
+     * \brief Checks if the slots of the owners are kept.
+     * 
+     * \return A boolean answering the check.
+     */
+    bool keepsSlots() const
+    { return slotsKept_; }
+
+    /**
+     * \brief Starts keeping the slots of the owners, for the data already
+     *        stored and the data inserted from now on.
+     * 
+     * \param slotOf Function giving the slot of an entity: (E) -> std::size_t
+     */
+    template <typename S>
+    void keepSlots(S&& slotOf)
+    {
+        if (slotsKept_)
+        { return; }
+
+        slotsKept_ = true;
+        slots_.reserve(owners_.capacity());
+        for (auto& e : owners_)
+        { slots_.push_back(slotOf(e)); }
+    }
+
+    /**
+     * \brief Gets the number of stored data.
+     * 
+     * \return The number of stored data.
+     */
+    auto size() const
+    { return data_.size(); }
+
+    /**
+     * \brief Changes the owner of the data at offset a, keeping the value
+     *        index in sync.
+     * 
+     * \param a The offset.
+     * \param e The new owner.
+     * \param s The slot of the new owner, only kept after "keepSlots".
+     */
+    void relocate(std::size_t a, E e, std::size_t s)
+    {
+        if constexpr (Indexed<T>)
+        {
+            index_.erase(Index_::key(data_[a]), owners_[a]);
+            index_.insert(Index_::key(data_[a]), e);
+        }
+
+        owners_[a] = e;
+        if (slotsKept_)
+        { slots_[a] = s; }
+    }
+
+    /**
+     * \brief Modifies the data at offset a through f, keeping the value
+     *        index in sync.
+     * 
+     * \param a The offset.
+     * \param f Function called on the data: (T&) -> void
+     */
+    template <typename F>
+    void modify(std::size_t a, F&& f)
+    {
+        if constexpr (Indexed<T>)
+        {
+            auto k = Index_::key(data_[a]);
+            f(data_[a]);
+            auto newK = Index_::key(data_[a]);
+            if (k != newK)
+            {
+                index_.erase(k, owners_[a]);
+                index_.insert(newK, owners_[a]);
+            }
+        }
+        else
+        { f(data_[a]); }
+    }
+
+    /**
+     * \brief Finds the entities whose data is indexed under key k.
+     * 
+     * \param k The key.
+     * 
+     * \return A view over the entities.
+     */
+    auto find(const auto& k) requires Indexed<T>
+    { return index_.find(k); }
+
+    /**
+     * \brief Finds the entities whose data is indexed under a key in [lo, hi).
+     * 
+     * \param lo The lower bound, included.
+     * \param hi The upper bound, excluded.
+     * 
+     * \return A view over the entities, ordered by key.
+     */
+    auto range(const auto& lo, const auto& hi) requires SortedIndexed<T>
+    { return index_.range(lo, hi); }
+
+    /**
+     * \brief Finds the entities whose data is indexed under a key strictly
+     *        lower than hi.
+     * 
+     * \param hi The upper bound, excluded.
+     * 
+     * \return A view over the entities, ordered by key.
+     */
+    auto below(const auto& hi) requires SortedIndexed<T>
+    { return index_.below(hi); }
+
+    /**
+     * \brief Finds the entities whose data is indexed under a key lower
+     *        or equal to hi.
+     * 
+     * \param hi The upper bound, included.
+     * 
+     * \return A view over the entities, ordered by key.
+     */
+    auto upTo(const auto& hi) requires SortedIndexed<T>
+    { return index_.upTo(hi); }
+
+    /**
+     * \brief Makes the data follow a placement, moving it to a new buffer.
+     * 
+     * \param p The placement, which must outlive the component. Can be null.
+     */
+    void place(const Placement* p)
+    {
+        numa::rebind(data_, p);
+        numa::rebind(owners_, p);
+        numa::rebind(slots_, p);
+    }
+
 private:
-    std::vector<T> data_;
-    std::vector<E> owners_;
+    std::vector<T, PlacedAllocator<T>> data_;
+    std::vector<E, PlacedAllocator<E>> owners_;
+    std::vector<std::size_t, PlacedAllocator<std::size_t>> slots_;
+    bool slotsKept_ = false;
+
+    struct NoIndex_ {};
+    using Index_ = std::conditional_t<Indexed<T>, ValueIndex<T, E>, NoIndex_>;
+
+    [[no_unique_address]] Index_ index_;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "numa.hpp"
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Represents a Component whose data is indexed directly by the slot
+ *        number of its owner. Holes are allowed and tracked by a presence
+ *        mask, so that accessing data is a single load and iterating is a
+ *        linear sweep.
+ * 
+ * \param T The type used, which must be default constructible.
+ */
+template <typename T>
+class DirectComponent
+{
+public:
+    /**
+     * \brief Inserts the data of slot s with value val.
+     * 
+     * \param s   The slot.
+     * \param val An optional default value, moved into the component.
+     */
+    void insert(std::size_t s, T val = {})
+    {
+        if (s >= data_.size())
+        {
+            auto size = std::max(s + 1, 2 * data_.size());
+            data_.resize(size);
+            mask_.resize((size + 63) / 64);
+        }
+
+        data_[s] = std::move(val);
+        mask_[s / 64] |= std::uint64_t(1) << (s % 64);
+    }
+
+    /**
+     * \brief Removes the data of slot s. The hole is reset to a default value.
+     * 
+     * \param s The slot.
+     */
+    void remove(std::size_t s)
+    {
+        data_[s] = T {};
+        mask_[s / 64] &= ~(std::uint64_t(1) << (s % 64));
+    }
+
+    /**
+     * \brief Moves the data of slot from to the free slot to.
+     * 
+     * \param from The slot having data.
+     * \param to   The slot receiving it.
+     */
+    void relocate(std::size_t from, std::size_t to)
+    {
+        insert(to, std::move(data_[from]));
+        remove(from);
+    }
+
+    /**
+     * \brief Accesses the data of slot s.
+     * 
+     * \param s The slot.
+     * 
+     * \return A reference to the data.
+     */
+    auto& access(std::size_t s)
+    { return data_[s]; }
+
+    /**
+     * \brief Gets the number of slots covered by the component, including
+     *        holes.
+     * 
+     * \return The number of slots.
+     */
+    auto size() const
+    { return data_.size(); }
+
+    /**
+     * \brief Calls f on every data of the slots in [first, last).
+     * 
+     * \param first The first slot.
+     * \param last  The slot past the last one.
+     * \param f     Function called on each data: (std::size_t, T&) -> void
+     */
+    template <typename F>
+    void forEach(std::size_t first, std::size_t last, F&& f)
+    {
+        last = std::min(last, data_.size());
+        for (auto s = first; s < last;)
+        {
+            auto word = mask_[s / 64] >> (s % 64);
+            if (word == 0)
+            {
+                s = (s / 64 + 1) * 64;
+                continue;
+            }
+
+            s += std::countr_zero(word);
+            if (s < last)
+            { f(s, data_[s]); }
+            s++;
+        }
+    }
+
+    /**
+     * \brief Makes the data follow a placement, moving it to a new buffer.
+     * 
+     * \param p The placement, which must outlive the component. Can be null.
+     */
+    void place(const Placement* p)
+    { numa::rebind(data_, p); }
+
+private:
+    std::vector<T, PlacedAllocator<T>> data_;
+    std::vector<std::uint64_t> mask_;
+};
+
+}
\ No newline at end of file
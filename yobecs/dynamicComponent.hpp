@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Describes a Component's type registered at runtime.
+ */
+struct DynamicType
+{
+    std::size_t size;
+    std::size_t align;
+
+    /**
+     * \brief Move constructs an object at dst from the object at src.
+     */
+    void (*move)(void* dst, void* src);
+
+    /**
+     * \brief Destroys the object at p.
+     */
+    void (*destroy)(void* p);
+
+    /**
+     * \brief Describes a C++ type as a DynamicType, for instance to store it
+     *        next to types only known at runtime.
+     * 
+     * \param T The type described.
+     * 
+     * \return The description.
+     */
+    template <typename T>
+    static DynamicType of()
+    {
+        return {
+            sizeof(T),
+            alignof(T),
+            [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); },
+            [](void* p) { static_cast<T*>(p)->~T(); }
+        };
+    }
+};
+
+/**
+ * \brief Represents a Component whose type is only known at runtime. Groups
+ *        data inside a contiguous buffer, found through an offset per slot
+ *        number of the owners.
+ */
+class DynamicComponent
+{
+public:
+    /**
+     * \brief Creates an empty Component of type t.
+     * 
+     * \param t The type used.
+     */
+    explicit DynamicComponent(const DynamicType& t)
+    : type_ { t }
+    , stride_ { (t.size + t.align - 1) / t.align * t.align }
+    {}
+
+    DynamicComponent(const DynamicComponent&) = delete;
+    DynamicComponent& operator=(const DynamicComponent&) = delete;
+
+    ~DynamicComponent()
+    {
+        for (std::size_t a = 0; a < owners_.size(); a++)
+        { type_.destroy(at(a)); }
+
+        release_(data_);
+    }
+
+    /**
+     * \brief Inserts the data of slot s, moved from val.
+     * 
+     * \param s   The slot.
+     * \param val The value, moved into the component.
+     */
+    void insert(std::size_t s, void* val)
+    {
+        if (owners_.size() == capacity_)
+        { grow_(std::max<std::size_t>(16, 2 * capacity_)); }
+
+        if (s >= offsets_.size())
+        { offsets_.resize(std::max(s + 1, 2 * offsets_.size()), none_); }
+
+        type_.move(at(owners_.size()), val);
+        offsets_[s] = owners_.size();
+        owners_.push_back(s);
+    }
+
+    /**
+     * \brief Removes the data of slot s.
+     * 
+     * \param s The slot.
+     */
+    void remove(std::size_t s)
+    {
+        auto a = offsets_[s];
+        auto last = owners_.size() - 1;
+        type_.destroy(at(a));
+        if (a != last)
+        {
+            type_.move(at(a), at(last));
+            type_.destroy(at(last));
+            owners_[a] = owners_[last];
+            offsets_[owners_[a]] = a;
+        }
+
+        offsets_[s] = none_;
+        owners_.pop_back();
+    }
+
+    /**
+     * \brief Gives the data of slot from to the free slot to, without moving
+     *        the data itself.
+     * 
+     * \param from The slot having data.
+     * \param to   The slot receiving it.
+     */
+    void relocate(std::size_t from, std::size_t to)
+    {
+        if (to >= offsets_.size())
+        { offsets_.resize(std::max(to + 1, 2 * offsets_.size()), none_); }
+
+        auto a = offsets_[from];
+        offsets_[to] = a;
+        offsets_[from] = none_;
+        owners_[a] = to;
+    }
+
+    /**
+     * \brief Checks if slot s has data.
+     * 
+     * \param s The slot.
+     * 
+     * \return A boolean answering the check.
+     */
+    bool has(std::size_t s) const
+    { return s < offsets_.size() && offsets_[s] != none_; }
+
+    /**
+     * \brief Accesses the data of slot s.
+     * 
+     * \param s The slot.
+     * 
+     * \return A pointer to the data.
+     */
+    void* access(std::size_t s)
+    { return at(offsets_[s]); }
+
+    /**
+     * \brief Accesses the data at offset a of the buffer.
+     * 
+     * \param a The offset.
+     * 
+     * \return A pointer to the data.
+     */
+    void* at(std::size_t a)
+    { return data_ + a * stride_; }
+
+    /**
+     * \brief Gets the slot owning the data at offset a.
+     * 
+     * \param a The offset.
+     * 
+     * \return The slot.
+     */
+    auto owner(std::size_t a) const
+    { return owners_[a]; }
+
+    /**
+     * \brief Gets the number of stored data.
+     * 
+     * \return The number of stored data.
+     */
+    auto size() const
+    { return owners_.size(); }
+
+private:
+    static constexpr auto none_ = std::numeric_limits<std::size_t>::max();
+
+    DynamicType type_;
+    std::size_t stride_;
+    std::byte* data_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::vector<std::size_t> owners_;
+    std::vector<std::size_t> offsets_;
+
+    void grow_(std::size_t capacity)
+    {
+        auto data = static_cast<std::byte*>(::operator new(capacity * stride_, std::align_val_t(type_.align)));
+        for (std::size_t a = 0; a < owners_.size(); a++)
+        {
+            type_.move(data + a * stride_, at(a));
+            type_.destroy(at(a));
+        }
+
+        release_(data_);
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    void release_(std::byte* data)
+    {
+        if (data)
+        { ::operator delete(data, std::align_val_t(type_.align)); }
+    }
+};
+
+}
\ No newline at end of file
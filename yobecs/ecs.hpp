@@ -1,17 +1,18 @@
 #pragma once
 
 #include "model.hpp"
+#include "worldSet.hpp"
 
 namespace yobtk {
 
 /**
  * \brief Implements a basic ECS (Entity-Component-System) design
  *        where Components are static but Entities and Systems are dynamic.
- *        This is a shortcut to "yobtk::ecs::Model<2048, Ts ...>"
+ *        This is a shortcut to "yobtk::ecs::Model<256, Ts ...>"
  * 
  * \param Ts List of types used in Components (must all be different).
  */
 template <typename ... Ts>
-using ECSModel = yobtk::ecs::Model<2048, Ts ...>;
+using ECSModel = yobtk::ecs::Model<256, Ts ...>;
 
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Type-erased interface of an EventChannel, used by the Model to
+ *        swap every channel at once.
+ */
+class EventChannelBase
+{
+public:
+    virtual ~EventChannelBase() = default;
+
+    /**
+     * \brief Publishes the events sent since the last swap and starts a new
+     *        batch. Must not be called concurrently with any other method.
+     */
+    virtual void swap() = 0;
+};
+
+/**
+ * \brief Represents a channel of events of type Ev. Events are written in a
+ *        contiguous buffer and published in batch by "swap", using double
+ *        buffering: the events sent during a frame are read during the next
+ *        one. Sending is thread safe and lock free as long as the number of
+ *        events stays under the highest count seen so far, so that the
+ *        steady state does not allocate.
+ * 
+ * \param Ev The event type.
+ */
+template <typename Ev>
+requires std::default_initializable<Ev> && std::copyable<Ev>
+class EventChannel : public EventChannelBase
+{
+public:
+    /**
+     * \brief Sends an event. Thread safe.
+     * 
+     * \param ev The event.
+     */
+    void send(const Ev& ev)
+    { sendMany(std::span<const Ev>(&ev, 1)); }
+
+    /**
+     * \brief Sends a batch of events. They are stored contiguously if
+     *        possible. Thread safe.
+     * 
+     * \param evs The events.
+     */
+    void sendMany(std::span<const Ev> evs)
+    {
+        auto i = next_.fetch_add(evs.size(), std::memory_order_relaxed);
+        auto size = write_.size();
+        auto inPlace = i < size ? std::min(evs.size(), size - i) : 0;
+        std::copy_n(evs.begin(), inPlace, write_.begin() + i);
+
+        if (inPlace < evs.size())
+        {
+            std::lock_guard lock (overflowMutex_);
+            overflow_.insert(overflow_.end(), evs.begin() + inPlace, evs.end());
+        }
+    }
+
+    /**
+     * \brief Reads the events published by the last swap.
+     * 
+     * \return A contiguous view over the events.
+     */
+    std::span<const Ev> read() const
+    { return { read_.data(), readCount_ }; }
+
+    /**
+     * \brief Publishes the events sent since the last swap and starts a new
+     *        batch. Must not be called concurrently with any other method.
+     */
+    void swap() override
+    {
+        readCount_ = next_.exchange(0, std::memory_order_relaxed);
+        if (!overflow_.empty())
+        {
+            write_.insert(write_.end(), overflow_.begin(), overflow_.end());
+            overflow_.clear();
+        }
+
+        std::swap(read_, write_);
+        if (write_.size() < read_.size())
+        { write_.resize(read_.size()); }
+    }
+
+    /**
+     * \brief Preallocates room for n events per batch.
+     * 
+     * \param n The number of events.
+     */
+    void reserve(std::size_t n)
+    {
+        if (write_.size() < n)
+        { write_.resize(n); }
+    }
+
+private:
+    std::vector<Ev> read_;
+    std::vector<Ev> write_;
+    std::size_t readCount_ = 0;
+    std::atomic<std::size_t> next_ = 0;
+
+    std::mutex overflowMutex_;
+    std::vector<Ev> overflow_;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Finalizes a 64 bits value so that each bit of the input affects
+ *        every bit of the output (the splitmix64 finalizer).
+ * 
+ * \param x The value.
+ * 
+ * \return The mixed value.
+ */
+inline constexpr std::uint64_t hashMix(std::uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * \brief Folds a range of bytes into 64 bits, 8 bytes at a time with a
+ *        single multiply per word. The result is not finalized: pass it to
+ *        "hashMix" to use it as a standalone hash.
+ * 
+ * \param p     The start of the range.
+ * \param bytes The size of the range.
+ * 
+ * \return The folded value.
+ */
+inline std::uint64_t foldBytes(const void* p, std::size_t bytes)
+{
+    auto c = static_cast<const unsigned char*>(p);
+    std::uint64_t h = 0x9e3779b97f4a7c15ull ^ bytes;
+    std::size_t i = 0;
+    for (; i + 8 <= bytes; i += 8)
+    {
+        std::uint64_t w;
+        std::memcpy(&w, c + i, 8);
+        h = std::rotl((h ^ w) * 0xff51afd7ed558ccdull, 29);
+    }
+
+    if (i < bytes)
+    {
+        std::uint64_t w = 0;
+        std::memcpy(&w, c + i, bytes - i);
+        h = std::rotl((h ^ w) * 0xff51afd7ed558ccdull, 29);
+    }
+
+    return h;
+}
+
+/**
+ * \brief Declares how a Component's type is hashed by "Model::hash".
+ *        Trivially copyable types are folded byte by byte, so their padding
+ *        bytes, if any, must not be left indeterminate. To hash another type
+ *        T, or to skip padding, specialise it with a static function
+ *        "hash(const T&)" returning a std::uint64_t. The result does not
+ *        need to be well mixed, as it is mixed with the Entity's id.
+ * 
+ * \param T The Component's type.
+ */
+template <typename T>
+struct HashTraits
+{
+    static std::uint64_t hash(const T& v) requires std::is_trivially_copyable_v<T>
+    { return foldBytes(&v, sizeof(T)); }
+};
+
+/**
+ * \brief Checks if a Component's type can be hashed.
+ */
+template <typename T>
+concept Hashable = requires (const T& v) {
+    { HashTraits<T>::hash(v) } -> std::convertible_to<std::uint64_t>;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "numa.hpp"
+#include "wrappedHandle.hpp"
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Represents a pool of worker threads executing jobs. Each worker owns
+ *        a deque of ready jobs: it pushes and pops at the back while idle
+ *        workers steal from the front of the others' deques. Jobs can depend
+ *        on other jobs, and waiting on a job executes pending jobs instead of
+ *        blocking, so that jobs can fork and join other jobs.
+ */
+class JobSystem
+{
+private:
+    struct Job_
+    {
+        std::function<void()> f;
+        std::atomic<std::size_t> pending { 1 };
+        std::atomic<bool> done { false };
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Job_>> continuations;
+    };
+
+    using JobPtr_ = std::shared_ptr<Job_>;
+
+public:
+    /**
+     * \brief Represents a submitted job for the user.
+     */
+    using JobHandle = WrappedHandle<JobPtr_>;
+
+    /**
+     * \brief Creates the worker threads.
+     * 
+     * \param workers Number of worker threads. Defaults to one per core
+     *                besides the calling thread, with a minimum of one.
+     */
+    explicit JobSystem(std::size_t workers = defaultWorkers_())
+    : queues_ (std::max<std::size_t>(workers, 1))
+    , workerNodes_ (std::max<std::size_t>(workers, 1), 0)
+    {
+        for (std::size_t i = 0; i < workers; i++)
+        { threads_.emplace_back([this, i]() { workerLoop_(i); }); }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * \brief Stops the worker threads once every ready job is executed.
+     */
+    ~JobSystem()
+    {
+        {
+            std::lock_guard lock (sleepMutex_);
+            stop_ = true;
+        }
+        sleepCv_.notify_all();
+
+        for (auto& t : threads_)
+        { t.join(); }
+    }
+
+    /**
+     * \brief Gets the number of worker threads.
+     * 
+     * \return The number of worker threads.
+     */
+    std::size_t workerCount() const
+    { return threads_.size(); }
+
+    /**
+     * \brief Restricts the workers to NUMA nodes, splitting them in
+     *        contiguous ranges of about the same size per node.
+     * 
+     * \return False if a worker could not be restricted, for instance on a
+     *         system without NUMA support. The worker's node is kept anyway.
+     */
+    bool pinWorkers()
+    {
+        auto nodes = numa::nodeCount();
+        auto ok = true;
+        for (std::size_t i = 0; i < threads_.size(); i++)
+        {
+            workerNodes_[i] = int(i * nodes / threads_.size());
+            ok = numa::pin(threads_[i], workerNodes_[i]) && ok;
+        }
+
+        return ok;
+    }
+
+    /**
+     * \brief Gets the NUMA node of a worker, given by "pinWorkers".
+     * 
+     * \param worker The worker.
+     * 
+     * \return The node, 0 if the workers are not pinned.
+     */
+    int workerNode(std::size_t worker) const
+    { return workerNodes_[worker]; }
+
+    /**
+     * \brief Submits a job executed once all of its dependencies are done.
+     *        Jobs must not throw.
+     * 
+     * \param f    Function executed by the job: () -> void
+     * \param deps Jobs that must be done before this one starts.
+     * 
+     * \return A handle to the job.
+     */
+    template <typename F>
+    JobHandle submit(F&& f, std::initializer_list<JobHandle> deps = {})
+    {
+        auto job = std::make_shared<Job_>();
+        job->f = std::forward<F>(f);
+        job->pending = 1 + deps.size();
+
+        for (auto d : deps)
+        {
+            auto& dep = *d;
+            std::unique_lock lock (dep->mutex);
+            if (dep->done)
+            {
+                lock.unlock();
+                release_(job);
+            }
+            else
+            { dep->continuations.push_back(job); }
+        }
+
+        release_(job);
+        return JobHandle(job);
+    }
+
+    /**
+     * \brief Submits a job without dependencies to the deque of a given
+     *        worker, so that related jobs tend to run on the same thread.
+     *        Other workers can still steal it.
+     * 
+     * \param worker The preferred worker, modulo the number of workers.
+     * \param f      Function executed by the job: () -> void
+     * 
+     * \return A handle to the job.
+     */
+    template <typename F>
+    JobHandle submitTo(std::size_t worker, F&& f)
+    {
+        auto job = std::make_shared<Job_>();
+        job->f = std::forward<F>(f);
+        job->pending = 0;
+        push_(job, worker % queues_.size());
+        return JobHandle(job);
+    }
+
+    /**
+     * \brief Waits for a job to be done, executing other jobs meanwhile.
+     * 
+     * \param h The job's handle.
+     */
+    void wait(JobHandle h)
+    {
+        auto& job = *h;
+        while (!job->done)
+        {
+            if (!tryRunOne_())
+            { std::this_thread::yield(); }
+        }
+    }
+
+    /**
+     * \brief Calls f on every chunk of at most grain indices of [first, last),
+     *        distributing the chunks among the calling thread and the workers.
+     *        Returns once every chunk is processed.
+     * 
+     * \param first The first index.
+     * \param last  The index past the last one.
+     * \param grain The maximum number of indices per chunk.
+     * \param f     Function called on each chunk: (std::size_t, std::size_t) -> void
+     */
+    template <typename F>
+    void parallelFor(std::size_t first, std::size_t last, std::size_t grain, F&& f)
+    {
+        if (first >= last)
+        { return; }
+
+        grain = std::max<std::size_t>(grain, 1);
+        auto chunks = (last - first + grain - 1) / grain;
+        std::atomic<std::size_t> next = 0;
+        auto body = [&]() {
+            for (auto c = next++; c < chunks; c = next++)
+            {
+                auto b = first + c * grain;
+                f(b, std::min(b + grain, last));
+            }
+        };
+
+        std::vector<JobHandle> helpers;
+        auto nHelpers = std::min(chunks - 1, workerCount());
+        helpers.reserve(nHelpers);
+        for (std::size_t i = 0; i < nHelpers; i++)
+        { helpers.push_back(submit(body)); }
+
+        body();
+        for (auto& h : helpers)
+        { wait(h); }
+    }
+
+private:
+    struct Queue_
+    {
+        std::mutex mutex;
+        std::deque<JobPtr_> jobs;
+    };
+
+    std::vector<Queue_> queues_;
+    std::vector<std::thread> threads_;
+    std::vector<int> workerNodes_;
+    std::atomic<std::size_t> nextQueue_ = 0;
+    std::atomic<std::size_t> queued_ = 0;
+
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;
+    bool stop_ = false;
+
+    static inline thread_local JobSystem* current_ = nullptr;
+    static inline thread_local std::size_t currentQueue_ = 0;
+
+    static std::size_t defaultWorkers_()
+    { return std::max(std::thread::hardware_concurrency(), 2u) - 1; }
+
+    void release_(const JobPtr_& job)
+    {
+        if (job->pending.fetch_sub(1) == 1)
+        { push_(job); }
+    }
+
+    void push_(JobPtr_ job)
+    { push_(std::move(job), current_ == this ? currentQueue_ : nextQueue_++ % queues_.size()); }
+
+    void push_(JobPtr_ job, std::size_t q)
+    {
+        {
+            std::lock_guard lock (queues_[q].mutex);
+            queues_[q].jobs.push_back(std::move(job));
+        }
+
+        queued_++;
+        { std::lock_guard lock (sleepMutex_); }
+        sleepCv_.notify_one();
+    }
+
+    JobPtr_ pop_()
+    {
+        auto own = current_ == this;
+        auto start = own ? currentQueue_ : 0;
+        for (std::size_t k = 0; k < queues_.size(); k++)
+        {
+            auto& q = queues_[(start + k) % queues_.size()];
+            std::lock_guard lock (q.mutex);
+            if (q.jobs.empty())
+            { continue; }
+
+            JobPtr_ job;
+            if (own && k == 0)
+            {
+                job = std::move(q.jobs.back());
+                q.jobs.pop_back();
+            }
+            else
+            {
+                job = std::move(q.jobs.front());
+                q.jobs.pop_front();
+            }
+
+            queued_--;
+            return job;
+        }
+
+        return nullptr;
+    }
+
+    bool tryRunOne_()
+    {
+        auto job = pop_();
+        if (!job)
+        { return false; }
+
+        job->f();
+        job->f = nullptr;
+
+        std::vector<JobPtr_> continuations;
+        {
+            std::lock_guard lock (job->mutex);
+            job->done = true;
+            continuations.swap(job->continuations);
+        }
+
+        for (auto& c : continuations)
+        { release_(c); }
+
+        return true;
+    }
+
+    void workerLoop_(std::size_t i)
+    {
+        current_ = this;
+        currentQueue_ = i;
+
+        while (true)
+        {
+            if (tryRunOne_())
+            { continue; }
+
+            std::unique_lock lock (sleepMutex_);
+            sleepCv_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+            if (stop_ && queued_ == 0)
+            { return; }
+        }
+    }
+};
+
+}
\ No newline at end of file
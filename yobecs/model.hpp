@@ -1,13 +1,36 @@
 #pragma once
 
-#include <bitset>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <future>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <new>
+#include <typeindex>
+#include <unordered_map>
 
 #include "utils.hpp"
+#include "accessCheck.hpp"
 #include "accessMatrix.hpp"
 #include "component.hpp"
+#include "directComponent.hpp"
+#include "dynamicComponent.hpp"
+#include "sparseComponent.hpp"
+#include "eventChannel.hpp"
+#include "hash.hpp"
+#include "jobSystem.hpp"
+#include "numa.hpp"
+#include "sharedWorld.hpp"
+#include "staging.hpp"
+#include "storage.hpp"
+#include "subModel.hpp"
 #include "wrappedHandle.hpp"
 #include "system.hpp"
+#include "systemGroup.hpp"
 
 namespace yobtk::ecs {
 
@@ -15,9 +38,11 @@ namespace yobtk::ecs {
  * \brief Implements a basic ECS (Entity-Component-System) design
  *        where Components are static but Entities and Systems are dynamic.
  * 
- * \param N  Parameter for the AccessMatrix system. Used as the number of 
- *           items per block.
- * \param Ts List of types used in Components (must all be different).
+ * \param N  Parameter for the AccessMatrix system. Used as the number of
+ *           items of the first block, the next ones growing geometrically.
+ * \param Ts List of types used in Components (must all be different). A type
+ *           can be wrapped in a storage policy, such as "Inline<T>",
+ *           "Direct<T>" or "Sparse<T>".
  */
 template <std::size_t N, typename ... Ts>
 class Model
@@ -25,11 +50,58 @@ class Model
 /* MISC */
 private:
     template <typename T>
-    static constexpr auto typeId_ = yobtk::utils::indexVariadicTypePack<T, Ts ...>;
+    static constexpr auto typeId_ = yobtk::utils::indexVariadicTypePack<T, ComponentType<Ts> ...>;
+
+/* STORAGE POLICIES */
+private:
+    static constexpr std::array<Storage, sizeof...(Ts)> policies_ { storagePolicy<Ts> ... };
+
+    template <typename T>
+    static constexpr auto policy_ = policies_[typeId_<T>];
+
+    static_assert(((storagePolicy<Ts> != Storage::Inline || InlineStorable<ComponentType<Ts>>) && ...),
+                  "Inline types must be small and trivially copyable");
+
+    static_assert(((storagePolicy<Ts> != Storage::Direct || std::default_initializable<ComponentType<Ts>>) && ...),
+                  "Direct types must be default constructible");
+
+    static constexpr std::size_t countDense_(std::size_t end)
+    {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < end; i++)
+        { n += policies_[i] == Storage::Dense; }
+        return n;
+    }
+
+    // Offset of each Inline type inside the inline data of an Entity,
+    // followed by the total size of the inline data.
+    static constexpr auto inlineLayout_ = [](){
+        constexpr std::array<std::size_t, sizeof...(Ts)> sizes { sizeof(ComponentType<Ts>) ... };
+        constexpr std::array<std::size_t, sizeof...(Ts)> aligns { alignof(ComponentType<Ts>) ... };
+        std::array<std::size_t, sizeof...(Ts) + 1> layout {};
+        std::size_t off = 0;
+        for (std::size_t i = 0; i < sizeof...(Ts); i++)
+        {
+            if (policies_[i] != Storage::Inline)
+            { continue; }
+
+            off = (off + aligns[i] - 1) / aligns[i] * aligns[i];
+            layout[i] = off;
+            off += sizes[i];
+        }
+        layout[sizeof...(Ts)] = off;
+        return layout;
+    }();
+
+    template <typename T>
+    static constexpr auto accessorId_ = countDense_(typeId_<T>);
 
 /* ACCESS MATRIX */
 private:
-    using AccessMatrix_ = AccessMatrix<N, sizeof...(Ts)>;
+    using AccessMatrix_ = AccessMatrix<N,
+                                       countDense_(sizeof...(Ts)),
+                                       sizeof...(Ts),
+                                       inlineLayout_[sizeof...(Ts)]>;
 
     AccessMatrix_ accessMatrix_;
 
@@ -48,9 +120,28 @@ public:
      */
     auto createEntity()
     {
-        Entity e (accessMatrix_.make());
+        Entity e (makeSlot_(nullptr));
+        spawnedEntities_.insert(e);
+        idsHash_ += hashMix(id(e));
+        insertInSystems_(e, sizeof...(Ts));
+        return e;
+    }
+
+    /**
+     * \brief Creates a new Entity next to another one when possible, that is
+     *        in the same block with the "Reuse::Lowest" policy.
+     * 
+     * \param near The Entity to stay close to.
+     * 
+     * \return A new entity. Beware that it might be
+     *         the same as an already deleted entity.
+     */
+    auto createEntity(Entity near)
+    {
+        Entity e (makeSlot_(*near));
         spawnedEntities_.insert(e);
-        insertInSystems_(e, Signature_());
+        idsHash_ += hashMix(id(e));
+        insertInSystems_(e, sizeof...(Ts));
         return e;
     }
 
@@ -62,18 +153,85 @@ public:
      */
     void removeEntity(Entity e)
     {
-        (checkedRemove_<Ts>(e), ...); 
-        accessMatrix_.free(*e);
+        static constexpr std::array<void (Model::*)(Entity), sizeof...(Ts)> removers {
+            &Model::template remove<ComponentType<Ts>> ...
+        };
+
+        // Only the types the Entity has are visited, through its signature.
+        auto s = computeSignature_(e);
+        s.forEach([&](std::size_t t) { (this->*removers[t])(e); });
+
+        for (DynamicId t = 0; t < dynamicComponents_.size(); t++)
+        {
+            if (has(e, t))
+            { remove(e, t); }
+        }
+
+        removeFromSystems_(e, sizeof...(Ts));
+        dropHandle_(accessMatrix_.slot(*e));
+        idsHash_ -= hashMix(id(e));
+        freeSlot_(*e);
         spawnedEntities_.erase(e);
-        removeFromSystems_(e, Signature_());
+    }
+
+    /**
+     * \brief Gets the slot number of an Entity, which identifies it among the
+     *        live Entities. Unlike the Entity itself, an address, it is
+     *        reproducible given the same sequence of operations.
+     * 
+     * \param e The Entity of interest.
+     * 
+     * \return The identifier.
+     */
+    std::size_t id(Entity e)
+    { return accessMatrix_.slot(*e); }
+
+    /**
+     * \brief Makes sure that n Entities can be created without allocating.
+     *        The slots of deleted Entities count, and the missing ones are
+     *        allocated at once in a single block. Which slots are used first
+     *        follows the reuse policy, so the Entities are not necessarily
+     *        contiguous.
+     * 
+     * \param n The number of Entities.
+     */
+    void reserveEntities(std::size_t n)
+    {
+        std::lock_guard lock (slotsMutex_);
+        accessMatrix_.reserve(n);
+    }
+
+    /**
+     * \brief Changes which slot of a deleted Entity is reused first by the
+     *        next created Entities.
+     * 
+     * \param r The reuse policy, "Reuse::Lifo" by default.
+     */
+    void setReusePolicy(Reuse r)
+    {
+        std::lock_guard lock (slotsMutex_);
+        accessMatrix_.reuse(r);
     }
 
 private:
     std::set<Entity> spawnedEntities_;
+    std::mutex slotsMutex_;
+
+    auto makeSlot_(typename AccessMatrix_::Index near)
+    {
+        std::lock_guard lock (slotsMutex_);
+        return accessMatrix_.make(near);
+    }
+
+    void freeSlot_(typename AccessMatrix_::Index i)
+    {
+        std::lock_guard lock (slotsMutex_);
+        accessMatrix_.free(i);
+    }
 
     template <typename T>
     auto& getAccess_(Entity e)
-    { return accessMatrix_.get(*e, typeId_<T>); }
+    { return accessMatrix_.get(*e, accessorId_<T>); }
 
     template <typename T>
     auto hasAccess_(Entity e)
@@ -81,7 +239,100 @@ private:
 
     template <typename T>
     void resetAccess_(Entity e)
-    { accessMatrix_.reset(*e, typeId_<T>); }
+    { accessMatrix_.reset(*e, accessorId_<T>); }
+
+    template <typename T>
+    auto getInline_(Entity e)
+    { return std::launder(reinterpret_cast<T*>(accessMatrix_.inlineData(*e, inlineLayout_[typeId_<T>]))); }
+
+/* HANDLES */
+public:
+    /**
+     * \brief Represents an Entity for the user that follows it when it is
+     *        moved by "defragment", and is detected as stale once the Entity
+     *        is removed: an index in a table of Entities, in the lower 32
+     *        bits, and the generation of that index.
+     */
+    using Handle = WrappedHandle<std::uint64_t>;
+
+    /**
+     * \brief Gets the Handle of an Entity, creating it on first call.
+     * 
+     * \param e The Entity of interest.
+     * 
+     * \return The Handle.
+     */
+    Handle handle(Entity e)
+    {
+        auto s = accessMatrix_.slot(*e);
+        if (s >= handleOfSlot_.size())
+        { handleOfSlot_.resize(std::max(s + 1, 2 * handleOfSlot_.size()), noHandle_); }
+
+        auto& i = handleOfSlot_[s];
+        if (i == noHandle_)
+        {
+            if (freeHandles_.empty())
+            {
+                i = handles_.size();
+                handles_.push_back({ e, 1 });
+            }
+            else
+            {
+                i = freeHandles_.back();
+                freeHandles_.pop_back();
+                handles_[i].entity = e;
+            }
+        }
+
+        return Handle((std::uint64_t(handles_[i].generation) << 32) | i);
+    }
+
+    /**
+     * \brief Checks if the Entity of a Handle still exists.
+     * 
+     * \param h The Handle of interest.
+     * 
+     * \return A boolean answering the check.
+     */
+    bool alive(Handle h)
+    {
+        auto i = *h & 0xffffffff;
+        return i < handles_.size() && handles_[i].generation == *h >> 32;
+    }
+
+    /**
+     * \brief Retrieves the current Entity of a Handle.
+     * 
+     * \param h The Handle of interest, which must be alive.
+     * 
+     * \return The Entity.
+     */
+    Entity resolve(Handle h)
+    { return handles_[*h & 0xffffffff].entity; }
+
+private:
+    struct HandleEntry_
+    {
+        Entity entity;
+        std::uint32_t generation;
+    };
+
+    static constexpr auto noHandle_ = std::numeric_limits<std::size_t>::max();
+
+    std::vector<HandleEntry_> handles_;
+    std::vector<std::size_t> freeHandles_;
+    std::vector<std::size_t> handleOfSlot_;
+
+    void dropHandle_(std::size_t s)
+    {
+        if (s >= handleOfSlot_.size() || handleOfSlot_[s] == noHandle_)
+        { return; }
+
+        auto i = handleOfSlot_[s];
+        handles_[i].generation++;
+        freeHandles_.push_back(i);
+        handleOfSlot_[s] = noHandle_;
+    }
 
 /* COMPONENTS */
 public:
@@ -90,14 +341,13 @@ public:
      * 
      * \param T   The type of the Component.
      * \param e   The Entity to be inserted.
-     * \param val An optional default value.
+     * \param val An optional default value, moved into the Component.
      */
     template <typename T>
-    void insert(Entity e, const T& val = {})
+    void insert(Entity e, T val = {})
     {
-        auto a = getComponent_<T>().insert(e, val);
-        getAccess_<T>(e) = a;
-        insertInSystems_(e, computeSignature_(e));
+        insertData_<T>(e, std::move(val));
+        insertInSystems_(e, typeId_<T>);
     }
 
     /**
@@ -109,144 +359,1523 @@ public:
     template <typename T>
     void remove(Entity e)
     {
-        auto a = getAccess_<T>(e);
-        auto repE = getComponent_<T>().remove(a);
-        resetAccess_<T>(e);
-    
-        if (repE != e)
-        { getAccess_<T>(repE) = a; }
+        touch_<T>(hashKey_<T>(e));
+        if constexpr (policy_<T> == Storage::Dense)
+        {
+            auto a = getAccess_<T>(e);
+            touch_<T>(getComponent_<T>().size() - 1);
+            auto repE = getComponent_<T>().remove(a);
+            resetAccess_<T>(e);
+        
+            if (repE != e)
+            { getAccess_<T>(repE) = a; }
+        }
+        else if constexpr (policy_<T> == Storage::Direct || policy_<T> == Storage::Sparse)
+        { getComponent_<T>().remove(accessMatrix_.slot(*e)); }
 
-        removeFromSystems_(e, computeSignature_<T>());
+        accessMatrix_.mark(*e, typeId_<T>, false);
+        removeFromSystems_(e, typeId_<T>);
     }
 
     /**
      * \brief Retrieves the data of an Entity e from the Component of
-     *        type T.
+     *        type T. The data of Indexed types is read only, so that their
+     *        index stays in sync: it must be written through "modify".
      * 
      * \param T The type of the Component.
      * \param e The Entity of interest.
      * 
-     * \return A reference to the stored data.
+     * \return A reference to the stored data, const for Indexed types.
      */
     template <typename T>
-    auto& access(Entity e)
-    { return getComponent_<T>().access(getAccess_<T>(e)); }
-
-private:
-    std::tuple<Component<Ts, Entity> ...> components_;
-
-    template<typename T>
-    auto& getComponent_()
-    { return std::get<typeId_<T>>(components_); }
-
-    template <typename T>
-    void checkedRemove_(Entity e)
+    std::conditional_t<Indexed<T>, const T&, T&> access(Entity e)
     {
-        if (hasAccess_<T>(e))
-        { remove<T>(e); }
+#if YOBECS_ACCESS_CHECKS
+        checkAccess_<T>(true);
+#endif
+        touch_<T>(hashKey_<T>(e));
+        return data_<T>(e);
     }
 
-/* SIGNATURES */
-private:
-    using Signature_ = std::bitset<sizeof...(Ts)>;
-
-    template <typename ... Us>
-    static auto computeSignature_()
+    /**
+     * \brief Retrieves the data of an Entity e from the Component of
+     *        type T, for reading only.
+     * 
+     * \param T The type of the Component.
+     * \param e The Entity of interest.
+     * 
+     * \return A const reference to the stored data.
+     */
+    template <typename T>
+    const auto& read(Entity e)
     {
-        static const auto s = (
-            Signature_()
-            | ... |
-            Signature_().set(typeId_<Us>));
-        return s;
+#if YOBECS_ACCESS_CHECKS
+        checkAccess_<T>(false);
+#endif
+        return data_<T>(e);
     }
 
-    auto computeSignature_(Entity e)
+    /**
+     * \brief Modifies the data of an Entity e from the Component of
+     *        type T. Must be used instead of "access" when changing the
+     *        indexed value of an Indexed type.
+     * 
+     * \param T The type of the Component.
+     * \param e The Entity of interest.
+     * \param f Function called on the data: (T&) -> void
+     */
+    template <typename T, typename F>
+    void modify(Entity e, F&& f)
     {
-        return (
-            Signature_()
-            | ... |
-            Signature_().set(typeId_<Ts>, hasAccess_<Ts>(e))
-        );
+#if YOBECS_ACCESS_CHECKS
+        checkAccess_<T>(true);
+#endif
+        touch_<T>(hashKey_<T>(e));
+        if constexpr (policy_<T> == Storage::Dense)
+        { getComponent_<T>().modify(getAccess_<T>(e), std::forward<F>(f)); }
+        else
+        { f(data_<T>(e)); }
     }
 
-/* SYSTEMS */
-private:
-    using System_       = System<Signature_, Entity, Model>;
-    using SystemPtr_    = std::unique_ptr<System_>;
+    /**
+     * \brief Finds the entities whose data in the Component of type T
+     *        is indexed under key k. T must declare an IndexTraits.
+     * 
+     * \param T The type of the Component.
+     * \param k The key of interest.
+     * 
+     * \return A view over the matching entities.
+     */
+    template <Indexed T>
+    auto find(const typename ValueIndex<T, Entity>::Key& k)
+    { return getComponent_<T>().find(k); }
+
+    /**
+     * \brief Finds the entities whose data in the Component of type T
+     *        is indexed under a key in [lo, hi). T must declare a sorted
+     *        IndexTraits.
+     * 
+     * \param T  The type of the Component.
+     * \param lo The lower bound, included.
+     * \param hi The upper bound, excluded.
+     * 
+     * \return A view over the matching entities, ordered by key, empty if
+     *         hi is not greater than lo.
+     */
+    template <SortedIndexed T>
+    auto range(const typename ValueIndex<T, Entity>::Key& lo,
+               const typename ValueIndex<T, Entity>::Key& hi)
+    { return getComponent_<T>().range(lo, hi); }
+
+    /**
+     * \brief Finds the entities whose data in the Component of type T
+     *        is indexed under a key strictly lower than hi.
+     * 
+     * \param T  The type of the Component.
+     * \param hi The upper bound, excluded.
+     * 
+     * \return A view over the matching entities, ordered by key.
+     */
+    template <SortedIndexed T>
+    auto below(const typename ValueIndex<T, Entity>::Key& hi)
+    { return getComponent_<T>().below(hi); }
+
+    /**
+     * \brief Finds the entities whose data in the Component of type T
+     *        is indexed under a key lower or equal to hi.
+     * 
+     * \param T  The type of the Component.
+     * \param hi The upper bound, included.
+     * 
+     * \return A view over the matching entities, ordered by key.
+     */
+    template <SortedIndexed T>
+    auto upTo(const typename ValueIndex<T, Entity>::Key& hi)
+    { return getComponent_<T>().upTo(hi); }
 
+/* LOADING */
 public:
     /**
-     * \brief Represents a System for the user.
+     * \brief Represents Entities and their data prepared outside of the Model.
      */
-    using SystemHandle = WrappedHandle<typename SystemPtr_::pointer>;
+    using Staging = yobtk::ecs::Staging<ComponentType<Ts> ...>;
 
     /**
-     * \brief Creates a new System attached to the types Us from the function f.
+     * \brief Prepares a Staging on a background thread.
      * 
-     * \param Us Set of types that the System is attached to.
-     * \param f  Function called to process entities. It must have the
-     *           following signature: (const std::set<Entity>&, Model&) -> void
+     * \param f Function filling the Staging: (Staging&) -> void
      * 
-     * \return A handle to the newly created System.
+     * \return A future holding the filled Staging, to be committed.
      */
-    template <typename ... Us>
-    auto createSystem(System_::ProcessF f)
+    template <typename F>
+    static std::future<Staging> loadAsync(F f)
     {
-        auto tmpSys = std::make_unique<System_>(computeSignature_<Us ...>(), f);
-        SystemHandle hSys (tmpSys.get());
-        auto& sys = systems_[hSys] = std::move(tmpSys);
+        return std::async(std::launch::async, [f = std::move(f)]() mutable {
+            Staging s;
+            f(s);
+            return s;
+        });
+    }
 
-        auto sSys = sys->signature();
-        for (auto e : spawnedEntities_)
+    /**
+     * \brief Creates the Entities of a Staging and moves their data into the
+     *        Components, in bulk.
+     * 
+     * \param s The Staging. Its data is moved out and it is cleared, so that
+     *          it can be filled again.
+     * 
+     * \return The created Entities, in the order of the local indices.
+     */
+    std::vector<Entity> commit(Staging& s)
+    {
+        std::vector<Entity> es;
+        es.reserve(s.size());
         {
-            auto s = computeSignature_(e);
-            if ((s & sSys) == sSys)
-            { sys->insert(e); }
+            std::lock_guard lock (slotsMutex_);
+            accessMatrix_.reserve(s.size());
+            for (std::size_t i = 0; i < s.size(); i++)
+            { es.emplace_back(accessMatrix_.make(es.empty() ? nullptr : *es.back())); }
         }
 
-        return hSys;
+        commitEntities_(s, es);
+        s.clear();
+        return es;
     }
 
     /**
-     * \brief Removes a System.
-     * 
-     * \param hSys A handle to the System to be removed.
+     * \brief Creates Entities from a worker thread. A Spawner is created,
+     *        committed and destroyed on the Model's thread, which reserves a
+     *        range of Entities for it each time, so that workers never touch
+     *        the Model's storage. A worker then hands out these Entities and
+     *        stages their data locally until it is committed. Its Entities
+     *        are valid handles right away, but they are only part of the
+     *        Model, its Components and Systems after the commit.
      */
-    void removeSystem(SystemHandle hSys)
-    { systems_.erase(hSys); }
+    class Spawner
+    {
+    public:
+        /**
+         * \brief Creates a Spawner reserving Entities by ranges of size n.
+         * 
+         * \param m The Model.
+         * \param n The number of Entities reserved at once, the maximum
+         *          number created between two commits.
+         */
+        Spawner(Model& m, std::size_t n = 256)
+        : m_ { m }
+        , rangeSize_ { std::max<std::size_t>(n, 1) }
+        {
+            {
+                std::lock_guard lock (m_.slotsMutex_);
+                m_.spawners_.push_back(this);
+            }
+
+            // Ranges are only reserved by the Model's thread, here and when
+            // committing, which also makes ids reproducible in deterministic
+            // mode when Spawners are created and committed in a reproducible
+            // order.
+            reserve_();
+        }
+
+        Spawner(const Spawner&) = delete;
+        Spawner& operator=(const Spawner&) = delete;
+
+        /**
+         * \brief Releases the reserved Entities that were not used. Staged
+         *        data that was not committed is lost.
+         */
+        ~Spawner()
+        {
+            std::lock_guard lock (m_.slotsMutex_);
+            std::erase(m_.spawners_, this);
+            release_();
+
+            for (auto e : used_)
+            { m_.accessMatrix_.free(*e); }
+        }
+
+        /**
+         * \brief Creates a new Entity from the reserved range. A Spawner must
+         *        not create more Entities than its range size between two
+         *        commits.
+         * 
+         * \return The new Entity.
+         */
+        Entity createEntity()
+        {
+            YOBECS_ENSURE(!reserved_.empty(), "a Spawner ran out of Entities between two commits");
+
+            auto e = reserved_.back();
+            reserved_.pop_back();
+            used_.push_back(e);
+            staging_.createEntity();
+            return e;
+        }
+
+        /**
+         * \brief Stages data of type T for the Entity e, created by this
+         *        Spawner since its last commit. Each Entity can receive at
+         *        most one data per type.
+         * 
+         * \param T   The type of the Component.
+         * \param e   The Entity.
+         * \param val An optional default value, moved into the Spawner.
+         */
+        template <typename T>
+        void insert(Entity e, T val = {})
+        { staging_.template insert<T>(local_(e), std::move(val)); }
+
+    private:
+        friend Model;
+
+        Model& m_;
+        std::size_t rangeSize_;
+        std::vector<Entity> reserved_;
+        std::vector<Entity> used_;
+        Staging staging_;
+
+        void reserve_()
+        {
+            std::lock_guard lock (m_.slotsMutex_);
+            refill_();
+        }
+
+        // Tops the reserved Entities up to a full range, the slots mutex
+        // being held.
+        void refill_()
+        {
+            std::vector<Entity> range;
+            for (auto i = reserved_.size(); i < rangeSize_; i++)
+            {
+                auto near = !range.empty()    ? *range.back()
+                          : reserved_.empty() ? typename AccessMatrix_::Index(nullptr)
+                                              : *reserved_.front();
+                range.emplace_back(m_.accessMatrix_.make(near));
+            }
+
+            // Entities are handed out from the back, in reservation order.
+            reserved_.insert(reserved_.begin(), range.rbegin(), range.rend());
+        }
+
+        // Gives back the reserved Entities, the slots mutex being held.
+        void release_()
+        {
+            for (auto e : reserved_)
+            { m_.accessMatrix_.free(*e); }
+            reserved_.clear();
+        }
+
+        std::size_t local_(Entity e)
+        {
+            // Entities are mostly staged right after their creation.
+            for (auto i = used_.size(); i-- > 0;)
+            {
+                if (used_[i] == e)
+                { return i; }
+            }
+
+            YOBECS_CHECK(false, "a Spawner stages data for an Entity it did not create since its last commit");
+            return used_.size();
+        }
+    };
 
     /**
-     * \brief Processes the entites. Calls "process(*this)" to
-     *        every created Systems.
+     * \brief Commits the Entities created by a Spawner and their data.
+     *        Must be called from the thread owning the Model, while the
+     *        Spawner is not used. Its range is topped up, so that it can be
+     *        used again afterwards.
+     * 
+     * \param sp The Spawner.
+     * 
+     * \return The committed Entities, in creation order.
      */
-    void process()
+    std::vector<Entity> commit(Spawner& sp)
     {
-        for (auto& [_, sys] : systems_)
-        { sys->process(*this); }
+        auto es = std::move(sp.used_);
+        sp.used_.clear();
+        commitEntities_(sp.staging_, es);
+        sp.staging_.clear();
+        sp.reserve_();
+        return es;
     }
 
 private:
-    std::map<SystemHandle, SystemPtr_> systems_;
+    // Live Spawners, whose reserved Entities are given back to defragment.
+    std::vector<Spawner*> spawners_;
 
-    void insertInSystems_(Entity e, Signature_ s)
+    void commitEntities_(Staging& s, const std::vector<Entity>& es)
     {
-        for (auto& [_, sys] : systems_)
+        for (auto e : es)
         {
-            auto sSys = sys->signature();
-            if ((s & sSys) == sSys)
-            { sys->insert(e); }
+            spawnedEntities_.insert(e);
+            idsHash_ += hashMix(id(e));
         }
+
+        (commitColumn_<ComponentType<Ts>>(s, es), ...);
+
+        for (auto e : es)
+        { insertInSystems_(e); }
     }
 
-    void removeFromSystems_(Entity e, Signature_ s)
+    template <typename T>
+    void commitColumn_(Staging& s, const std::vector<Entity>& es)
     {
-        for (auto& [_, sys] : systems_)
+        auto& col = s.template column<T>();
+        if (col.entities.empty())
+        { return; }
+
+        if constexpr (policy_<T> == Storage::Dense)
         {
-            auto sSys = sys->signature();
-            if ((s & sSys) == sSys)
-            { sys->remove(e); }
+            std::vector<Entity> owners;
+            owners.reserve(col.entities.size());
+            for (auto i : col.entities)
+            { owners.push_back(es[i]); }
+
+            auto a = getComponent_<T>().insertMany(owners, std::move(col.data), [this](Entity e) { return id(e); });
+            for (auto e : owners)
+            {
+                touch_<T>(a);
+                getAccess_<T>(e) = a++;
+                accessMatrix_.mark(*e, typeId_<T>, true);
+            }
         }
+        else
+        {
+            for (std::size_t k = 0; k < col.entities.size(); k++)
+            { insertData_<T>(es[col.entities[k]], std::move(col.data[k])); }
+        }
+
+        col.entities.clear();
+        col.data.clear();
+    }
+
+private:
+    struct NoComponent_ {};
+
+    template <typename T>
+    using Storage_ = std::conditional_t<storagePolicy<T> == Storage::Dense,
+                                        Component<ComponentType<T>, Entity>,
+                     std::conditional_t<storagePolicy<T> == Storage::Direct,
+                                        DirectComponent<ComponentType<T>>,
+                     std::conditional_t<storagePolicy<T> == Storage::Sparse,
+                                        SparseComponent<ComponentType<T>>,
+                                        NoComponent_>>>;
+
+    yobtk::utils::FlatTuple<Storage_<Ts> ...> components_;
+
+    template<typename T>
+    auto& getComponent_()
+    { return yobtk::utils::get<typeId_<T>>(components_); }
+
+    template <typename T>
+    void insertData_(Entity e, T&& val)
+    {
+        static_assert(policy_<T> == Storage::Dense || !Indexed<T>,
+                      "Value indexes require the Dense storage policy");
+
+        if constexpr (policy_<T> == Storage::Dense)
+        { getAccess_<T>(e) = getComponent_<T>().insert(e, accessMatrix_.slot(*e), std::move(val)); }
+        else if constexpr (policy_<T> == Storage::Direct || policy_<T> == Storage::Sparse)
+        { getComponent_<T>().insert(accessMatrix_.slot(*e), std::move(val)); }
+        else
+        { new (accessMatrix_.inlineData(*e, inlineLayout_[typeId_<T>])) T(val); }
+
+        touch_<T>(hashKey_<T>(e));
+        accessMatrix_.mark(*e, typeId_<T>, true);
+    }
+
+    template <typename T>
+    T& data_(Entity e)
+    {
+        if constexpr (policy_<T> == Storage::Dense)
+        { return getComponent_<T>().access(getAccess_<T>(e)); }
+        else if constexpr (policy_<T> == Storage::Direct || policy_<T> == Storage::Sparse)
+        { return getComponent_<T>().access(accessMatrix_.slot(*e)); }
+        else
+        { return *getInline_<T>(e); }
+    }
+
+/* DYNAMIC COMPONENTS */
+public:
+    /**
+     * \brief Identifies a Component's type registered at runtime.
+     */
+    using DynamicId = std::size_t;
+
+    /**
+     * \brief Registers a Component's type at runtime, for instance from a
+     *        scripting layer. Its data is stored in a type-erased contiguous
+     *        buffer, and Systems can be attached to it with "attach".
+     * 
+     * \param t The description of the type.
+     * 
+     * \return The identifier of the new type.
+     */
+    DynamicId registerType(const DynamicType& t)
+    {
+        dynamicComponents_.push_back(std::make_unique<DynamicComponent>(t));
+        systemsByDynamicType_.emplace_back();
+        return dynamicComponents_.size() - 1;
     }
+
+    /**
+     * \brief Inserts the Entity e inside the dynamic Component t.
+     * 
+     * \param e   The Entity to be inserted.
+     * \param t   The dynamic type.
+     * \param val A pointer to the value, moved into the Component.
+     */
+    void insert(Entity e, DynamicId t, void* val)
+    {
+        dynamicComponents_[t]->insert(accessMatrix_.slot(*e), val);
+
+        const auto& s = computeSignature_(e);
+        for (auto sys : systemsByDynamicType_[t])
+        {
+            if (matches_(*sys, e, s))
+            { sys->insert(e); }
+        }
+    }
+
+    /**
+     * \brief Removes the Entity e from the dynamic Component t.
+     * 
+     * \param e The Entity to be removed.
+     * \param t The dynamic type.
+     */
+    void remove(Entity e, DynamicId t)
+    {
+        dynamicComponents_[t]->remove(accessMatrix_.slot(*e));
+        for (auto sys : systemsByDynamicType_[t])
+        { sys->remove(e); }
+    }
+
+    /**
+     * \brief Checks if the Entity e has data in the dynamic Component t.
+     * 
+     * \param e The Entity of interest.
+     * \param t The dynamic type.
+     * 
+     * \return A boolean answering the check.
+     */
+    bool has(Entity e, DynamicId t)
+    { return dynamicComponents_[t]->has(accessMatrix_.slot(*e)); }
+
+    /**
+     * \brief Retrieves the data of an Entity e from the dynamic Component t.
+     * 
+     * \param e The Entity of interest.
+     * \param t The dynamic type.
+     * 
+     * \return A pointer to the stored data.
+     */
+    void* access(Entity e, DynamicId t)
+    { return dynamicComponents_[t]->access(accessMatrix_.slot(*e)); }
+
+private:
+    std::vector<std::unique_ptr<DynamicComponent>> dynamicComponents_;
+
+/* EVENTS */
+public:
+    /**
+     * \brief Retrieves the channel of events of type Ev, creating it on
+     *        first use. Events sent during a call to "process" are readable
+     *        during the next one. The first call for a given type must not
+     *        happen concurrently with other calls.
+     * 
+     * \param Ev The type of the events.
+     * 
+     * \return A reference to the channel.
+     */
+    template <typename Ev>
+    auto& events()
+    {
+        auto& c = eventChannels_[typeid(Ev)];
+        if (!c)
+        { c = std::make_unique<EventChannel<Ev>>(); }
+
+        return static_cast<EventChannel<Ev>&>(*c);
+    }
+
+private:
+    std::unordered_map<std::type_index, std::unique_ptr<EventChannelBase>> eventChannels_;
+
+    void swapEvents_()
+    {
+        for (auto& [_, c] : eventChannels_)
+        { c->swap(); }
+    }
+
+/* JOBS */
+public:
+    /**
+     * \brief Retrieves the JobSystem used by the Model, creating it on first
+     *        use. Systems can use it for nested parallelism.
+     * 
+     * \return A reference to the JobSystem.
+     */
+    JobSystem& jobs()
+    {
+        if (!jobs_)
+        { jobs_ = std::make_shared<JobSystem>(); }
+
+        return *jobs_;
+    }
+
+    /**
+     * \brief Makes the Model use another JobSystem, which can be shared
+     *        between Models. Must not be called during "process".
+     * 
+     * \param jobs The JobSystem.
+     */
+    void setJobSystem(std::shared_ptr<JobSystem> jobs)
+    { jobs_ = std::move(jobs); }
+
+    /**
+     * \brief Calls f on every data of the Component of type T, in parallel
+     *        chunks of consecutive data. Direct and Inline Components are
+     *        swept by chunks of slots, skipping the holes. f must not create or
+     *        remove Entities nor insert or remove data.
+     * 
+     * \param T     The type of the Component, which must not be Indexed.
+     * \param f     Function called on each data: (Entity, T&) -> void
+     * \param grain Number of data per chunk.
+     */
+    template <typename T, typename F>
+    void parallelEach(F&& f, std::size_t grain = 1024)
+    {
+        static_assert(!Indexed<T>, "Indexed Components must be written through modify");
+
+#if YOBECS_ACCESS_CHECKS
+        checkAccess_<T>(true);
+#endif
+        touchAll_<T>();
+        if constexpr (policy_<T> == Storage::Dense)
+        {
+            auto& c = getComponent_<T>();
+            parallelFor_(c.size(), grain, [&](std::size_t first, std::size_t last) {
+                for (auto a = first; a < last; a++)
+                { f(c.owner(a), c.access(a)); }
+            });
+        }
+        else if constexpr (policy_<T> == Storage::Direct)
+        {
+            auto& c = getComponent_<T>();
+            parallelFor_(c.size(), grain, [&](std::size_t first, std::size_t last) {
+                c.forEach(first, last, [&](std::size_t s, T& val) {
+                    f(Entity(accessMatrix_.at(s)), val);
+                });
+            });
+        }
+        else if constexpr (policy_<T> == Storage::Sparse)
+        {
+            auto& c = getComponent_<T>();
+            parallelFor_(c.size(), grain, [&](std::size_t first, std::size_t last) {
+                for (auto a = first; a < last; a++)
+                { f(Entity(accessMatrix_.at(c.owner(a))), c.at(a)); }
+            });
+        }
+        else
+        {
+            parallelFor_(accessMatrix_.capacity(), grain, [&](std::size_t first, std::size_t last) {
+                accessMatrix_.forEach(first, last, [&](typename AccessMatrix_::Index i) {
+                    if (accessMatrix_.has(i, typeId_<T>))
+                    { f(Entity(i), *getInline_<T>(Entity(i))); }
+                });
+            });
+        }
+    }
+
+private:
+    std::shared_ptr<JobSystem> jobs_;
+
+    // Calls f on the chunks of [0, n) in parallel, the chunks seeing the
+    // time step and System of the calling thread, for "deltaTime" and the
+    // access checks.
+    template <typename F>
+    void parallelFor_(std::size_t n, std::size_t grain, F&& f)
+    {
+        auto step = step_;
+        jobs().parallelFor(0, n, grain, [&](std::size_t first, std::size_t last) {
+            auto prev = std::exchange(step_, step);
+            f(first, last);
+            step_ = prev;
+        });
+    }
+
+/* PLACEMENT */
+public:
+    /**
+     * \brief Places the storage of the Model on a NUMA machine: the blocks of
+     *        Entities and the data of every Component. Existing storage is
+     *        moved. Placements are ignored on machines without NUMA support.
+     * 
+     * \param p The placement, for instance "Placement::onNode(n)", or
+     *          "Placement::huge()" to back large arrays with huge pages.
+     */
+    void setPlacement(Placement p)
+    {
+        accessMatrix_.place(p);
+        (setPlacement<ComponentType<Ts>>(p), ...);
+    }
+
+    /**
+     * \brief Places the data of the Component of type T on a NUMA machine,
+     *        for instance to interleave a large array read from every node.
+     *        Inline data follows the blocks of Entities instead.
+     * 
+     * \param T The type of the Component.
+     * \param p The placement.
+     */
+    template <typename T>
+    void setPlacement(Placement p)
+    {
+        placements_[typeId_<T>] = p;
+        if constexpr (policy_<T> != Storage::Inline)
+        { getComponent_<T>().place(&placements_[typeId_<T>]); }
+    }
+
+private:
+    std::array<Placement, sizeof...(Ts)> placements_;
+
+/* DEFRAGMENTATION */
+public:
+    /**
+     * \brief Moves up to budget Entities to the lowest free slots, so that
+     *        live Entities end up packed in the first blocks, and releases
+     *        the blocks left empty at the end. Meant to be called between
+     *        frames with a small budget. The Entities reserved by Spawners
+     *        but not created yet are given back first, then reserved again. Switches the reuse policy to
+     *        "Reuse::Lowest", so that new Entities fill the remaining holes.
+     *        A moved Entity changes: the Entity values held by the user, for
+     *        instance inside Components, are invalidated. Handles follow it.
+     * 
+     * \param budget The maximum number of Entities moved.
+     * 
+     * \return The number of Entities moved, lower than budget once packed.
+     *         Nothing is moved while a Spawner holds Entities that are not
+     *         committed yet.
+     */
+    std::size_t defragment(std::size_t budget)
+    {
+        std::lock_guard lock (slotsMutex_);
+        for (auto sp : spawners_)
+        {
+            if (!sp->used_.empty())
+            { return 0; }
+        }
+
+        for (auto sp : spawners_)
+        { sp->release_(); }
+
+        accessMatrix_.reuse(Reuse::Lowest);
+
+        std::size_t moved = 0;
+        for (; moved < budget; moved++)
+        {
+            auto [from, to] = accessMatrix_.nextMove();
+            if (!from)
+            { break; }
+
+            relocate_(Entity(from), to);
+        }
+
+        for (auto sp : spawners_)
+        { sp->refill_(); }
+
+        return moved;
+    }
+
+private:
+    void relocate_(Entity e, typename AccessMatrix_::Index to)
+    {
+        static constexpr std::array<void (Model::*)(std::size_t, Entity), sizeof...(Ts)> relocators {
+            &Model::template relocateData_<ComponentType<Ts>> ...
+        };
+
+        for (auto& [_, sys] : systems_)
+        { sys->remove(e); }
+        spawnedEntities_.erase(e);
+
+        auto from = accessMatrix_.slot(*e);
+        auto s = accessMatrix_.slot(to);
+        idsHash_ += hashMix(s) - hashMix(from);
+        accessMatrix_.relocate(*e, to);
+
+        Entity n (to);
+        computeSignature_(n).forEach([&](std::size_t t) { (this->*relocators[t])(from, n); });
+        for (auto& c : dynamicComponents_)
+        {
+            if (c->has(from))
+            { c->relocate(from, s); }
+        }
+
+        if (from < handleOfSlot_.size() && handleOfSlot_[from] != noHandle_)
+        {
+            handles_[handleOfSlot_[from]].entity = n;
+            handleOfSlot_[s] = handleOfSlot_[from];
+            handleOfSlot_[from] = noHandle_;
+        }
+
+        spawnedEntities_.insert(n);
+        insertInSystems_(n);
+    }
+
+    template <typename T>
+    void relocateData_(std::size_t from, Entity n)
+    {
+        if constexpr (policy_<T> != Storage::Dense)
+        { touch_<T>(from); }
+        touch_<T>(hashKey_<T>(n));
+        if constexpr (policy_<T> == Storage::Dense)
+        { getComponent_<T>().relocate(getAccess_<T>(n), n, accessMatrix_.slot(*n)); }
+        else if constexpr (policy_<T> == Storage::Direct || policy_<T> == Storage::Sparse)
+        { getComponent_<T>().relocate(from, accessMatrix_.slot(*n)); }
+    }
+
+/* HASHING */
+public:
+    /**
+     * \brief Computes a 64 bits hash of the live Entities and of their data
+     *        in the Components of types Us, for instance to detect desyncs
+     *        between machines running the same simulation. Entities are
+     *        identified by "id". Each Entity, and each pair of an Entity and
+     *        its data, is hashed on its own and the results are summed, so
+     *        that the hash does not depend on where data lies in memory.
+     *        Components are hashed by chunks, in parallel, and the hash of a
+     *        chunk is kept until its data is written again, through "access",
+     *        "modify", "parallelEach" or structural changes. Writing through
+     *        a reference kept from an earlier frame is not detected.
+     * 
+     * \param Us The types of the Components hashed, which must be Hashable.
+     * 
+     * \return The hash.
+     */
+    template <typename ... Us>
+    std::uint64_t hash()
+    { return idsHash_ + (std::uint64_t(0) + ... + hashColumn_<Us>()); }
+
+private:
+    // Number of data, or of slots, per chunk of a Component's hash.
+    static constexpr std::size_t hashChunk_ = 4096;
+
+    // Hashes of the chunks of a Component, and whether they were written
+    // since. Sparse Components are a single chunk.
+    struct HashCache_
+    {
+        std::vector<std::uint64_t> sums;
+        std::vector<std::uint8_t> dirty;
+    };
+
+    std::array<HashCache_, sizeof...(Ts)> hashCaches_;
+    std::uint64_t idsHash_ = 0;
+
+    // Offset of the data of e for Dense Components, its slot otherwise.
+    template <typename T>
+    std::size_t hashKey_(Entity e)
+    {
+        if constexpr (policy_<T> == Storage::Dense)
+        { return getAccess_<T>(e); }
+        else
+        { return accessMatrix_.slot(*e); }
+    }
+
+    // Marks the chunk holding key k as written. Cheap when never hashed,
+    // and safe from concurrent Systems.
+    template <typename T>
+    void touch_(std::size_t k)
+    {
+        auto& dirty = hashCaches_[typeId_<T>].dirty;
+        auto c = policy_<T> == Storage::Sparse ? 0 : k / hashChunk_;
+        if (c >= dirty.size())
+        { return; }
+
+        std::atomic_ref<std::uint8_t> d (dirty[c]);
+        if (!d.load(std::memory_order_relaxed))
+        { d.store(1, std::memory_order_relaxed); }
+    }
+
+    template <typename T>
+    void touchAll_()
+    {
+        auto& dirty = hashCaches_[typeId_<T>].dirty;
+        std::fill(dirty.begin(), dirty.end(), 1);
+    }
+
+    template <typename T>
+    static std::uint64_t hashData_(std::size_t s, const T& val)
+    { return hashMix(HashTraits<T>::hash(val) ^ ((s + (std::uint64_t(typeId_<T> + 1) << 40)) * 0x9e3779b97f4a7c15ull)); }
+
+    template <typename T>
+    std::uint64_t hashColumn_()
+    {
+        static_assert(Hashable<T>, "T must be hashable, see HashTraits");
+
+        // Dense Components keep the slots of their owners once hashed, so
+        // that hashing does not load the owners' rows.
+        if constexpr (policy_<T> == Storage::Dense)
+        { getComponent_<T>().keepSlots([this](Entity e) { return id(e); }); }
+
+        auto n = rangeSize_<T>();
+        auto& cache = hashCaches_[typeId_<T>];
+        auto chunks = policy_<T> == Storage::Sparse ? 1 : (n + hashChunk_ - 1) / hashChunk_;
+        cache.sums.resize(chunks, 0);
+        cache.dirty.resize(chunks, 1);
+
+        auto rehash = [&](std::size_t first, std::size_t last) {
+            for (auto c = first; c < last; c++)
+            {
+                if (!cache.dirty[c])
+                { continue; }
+
+                cache.dirty[c] = 0;
+                cache.sums[c] = policy_<T> == Storage::Sparse ? hashRange_<T>(0, n)
+                                                              : hashRange_<T>(c * hashChunk_, std::min(n, (c + 1) * hashChunk_));
+            }
+        };
+
+        if (chunks > 1)
+        { jobs().parallelFor(0, chunks, 1, rehash); }
+        else
+        { rehash(0, chunks); }
+
+        std::uint64_t h = 0;
+        for (auto sum : cache.sums)
+        { h += sum; }
+
+        return h;
+    }
+
+    // Hashes the data of offsets, or slots, [first, last).
+    template <typename T>
+    std::uint64_t hashRange_(std::size_t first, std::size_t last)
+    {
+        std::uint64_t h = 0;
+        eachInRange_<T>(first, last, [&](std::size_t s, T& val) { h += hashData_(s, val); });
+        return h;
+    }
+
+    // Upper bound of the offsets, or slots, of the data of a Component.
+    template <typename T>
+    std::size_t rangeSize_()
+    {
+        if constexpr (policy_<T> == Storage::Inline)
+        { return accessMatrix_.capacity(); }
+        else
+        { return getComponent_<T>().size(); }
+    }
+
+    // Calls f on the slot of the owner and on the data of offsets, or slots,
+    // [first, last), in storage order.
+    template <typename T, typename F>
+    void eachInRange_(std::size_t first, std::size_t last, F&& f)
+    {
+        if constexpr (policy_<T> == Storage::Dense)
+        {
+            auto& c = getComponent_<T>();
+            if (c.keepsSlots())
+            {
+                for (auto a = first; a < last; a++)
+                { f(c.slot(a), c.access(a)); }
+            }
+            else
+            {
+                for (auto a = first; a < last; a++)
+                { f(id(c.owner(a)), c.access(a)); }
+            }
+        }
+        else if constexpr (policy_<T> == Storage::Direct)
+        { getComponent_<T>().forEach(first, last, f); }
+        else if constexpr (policy_<T> == Storage::Sparse)
+        {
+            auto& c = getComponent_<T>();
+            for (auto a = first; a < last; a++)
+            { f(c.owner(a), c.at(a)); }
+        }
+        else
+        {
+            accessMatrix_.forEach(first, last, [&](typename AccessMatrix_::Index i) {
+                if (accessMatrix_.has(i, typeId_<T>))
+                { f(accessMatrix_.slot(i), *getInline_<T>(Entity(i))); }
+            });
+        }
+    }
+
+/* SHARED MEMORY */
+public:
+    /**
+     * \brief Copies the data of the Components of types Us into a shared
+     *        memory segment, as the next frame seen by SharedWorldReaders of
+     *        other processes. Entities are identified by "id". Typically
+     *        called once per frame, after "process".
+     * 
+     * \param w The writer owning the segment, whose types are Us.
+     * 
+     * \return False if the writer is not valid, or if a Component has more
+     *         data than its capacity or an id reaches it, in which case the
+     *         frame is dropped and readers keep seeing the previous one.
+     */
+    template <typename ... Us>
+    bool publish(SharedWorldWriter<Us ...>& w)
+    {
+        if (!w.valid())
+        { return false; }
+
+        w.beginFrame();
+        auto ok = true;
+        ([&](){
+            if (ok)
+            { eachInRange_<Us>(0, rangeSize_<Us>(), [&](std::size_t s, Us& val) { ok = ok && w.append(s, val); }); }
+        }(), ...);
+
+        w.endFrame(ok);
+        return ok;
+    }
+
+/* SIGNATURES */
+private:
+    using Signature_ = typename AccessMatrix_::Signature;
+
+    template <typename ... Us>
+    static auto computeSignature_()
+    {
+        static const auto s = (
+            Signature_()
+            | ... |
+            Signature_().set(typeId_<BareType<Us>>));
+        return s;
+    }
+
+    template <typename ... Us>
+    static auto computeWrites_()
+    {
+        static const auto s = (
+            Signature_()
+            | ... |
+            Signature_().set(typeId_<BareType<Us>>, !isRead<Us>));
+        return s;
+    }
+
+    const auto& computeSignature_(Entity e)
+    { return accessMatrix_.signature(*e); }
+
+/* SYSTEMS */
+private:
+    using System_       = System<Signature_, Entity, Model>;
+    using SystemPtr_    = std::unique_ptr<System_>;
+
+public:
+    /**
+     * \brief Represents a System for the user.
+     */
+    using SystemHandle = WrappedHandle<typename SystemPtr_::pointer>;
+
+/* SYSTEM GROUPS */
+private:
+    using SystemGroup_    = SystemGroup<SystemHandle>;
+    using SystemGroupPtr_ = std::unique_ptr<SystemGroup_>;
+
+public:
+    /**
+     * \brief Represents a group of Systems for the user.
+     */
+    using GroupHandle = WrappedHandle<typename SystemGroupPtr_::pointer>;
+
+    /**
+     * \brief Creates a new group of Systems. Groups are processed in their
+     *        creation order, after the default group.
+     * 
+     * \param timestep How elapsed time is converted into System calls.
+     * \param rate     Number of calls per second. Ignored for Variable groups.
+     * \param maxSteps Maximum number of steps per frame of a Fixed group.
+     * 
+     * \return A handle to the newly created group.
+     */
+    GroupHandle createGroup(Timestep timestep, double rate = 0.0, std::size_t maxSteps = 8)
+    {
+        auto& g = groups_.emplace_back(std::make_unique<SystemGroup_>(timestep, rate, maxSteps));
+        return GroupHandle(g.get());
+    }
+
+    /**
+     * \brief Gets the default group, in which Systems are processed once
+     *        per frame.
+     * 
+     * \return A handle to the default group.
+     */
+    GroupHandle defaultGroup()
+    { return GroupHandle(groups_.front().get()); }
+
+    /**
+     * \brief Moves a System to another group, at the end of its phase.
+     *        Its ordering constraints are dropped.
+     * 
+     * \param hSys   A handle to the System.
+     * \param hGroup A handle to the new group.
+     */
+    void setGroup(SystemHandle hSys, GroupHandle hGroup)
+    {
+        auto& g = groupOf_(hSys);
+        auto phase = g.phase(hSys);
+        g.remove(hSys);
+        (*hGroup)->insert(hSys, phase);
+    }
+
+    /**
+     * \brief Changes the phase of a System inside its group.
+     * 
+     * \param hSys  A handle to the System.
+     * \param phase The new phase.
+     * 
+     * \return False if the phase contradicts an ordering constraint, in
+     *         which case nothing is changed.
+     */
+    bool setPhase(SystemHandle hSys, Phase phase)
+    { return groupOf_(hSys).setPhase(hSys, phase); }
+
+    /**
+     * \brief Constrains a System to be processed before another one of
+     *        the same group.
+     * 
+     * \param hFirst  A handle to the System processed first.
+     * \param hSecond A handle to the System processed second.
+     * 
+     * \return False if the Systems are in different groups or if the
+     *         constraint creates a cycle or contradicts their phases, in
+     *         which case it is discarded.
+     */
+    bool runBefore(SystemHandle hFirst, SystemHandle hSecond)
+    {
+        auto& g = groupOf_(hFirst);
+        return g.contains(hSecond) && g.order(hFirst, hSecond);
+    }
+
+    /**
+     * \brief Allows a System to access the Components of types Us, on top of
+     *        the ones it is attached to. Types wrapped in "Read" are only
+     *        read, through "Model::read". Only used by the access checks.
+     * 
+     * \param Us   Set of types the System may access.
+     * \param hSys A handle to the System.
+     */
+    template <typename ... Us>
+    void allowAccess([[maybe_unused]] SystemHandle hSys)
+    {
+#if YOBECS_ACCESS_CHECKS
+        (*hSys)->allow(computeSignature_<Us ...>(), computeWrites_<Us ...>());
+#endif
+    }
+
+    /**
+     * \brief Allows the Systems of a group to be processed in parallel by
+     *        the Model's JobSystem. Systems of the same phase that are not
+     *        ordered by "runBefore" may then run concurrently, so they must
+     *        not modify the same data nor create or remove Entities and
+     *        Systems.
+     * 
+     * \param hGroup   A handle to the group.
+     * \param parallel A boolean enabling or disabling parallel processing.
+     */
+    void setParallel(GroupHandle hGroup, bool parallel = true)
+    {
+        if (parallel)
+        { jobs(); }
+
+        (*hGroup)->setParallel(parallel);
+    }
+
+    /**
+     * \brief Removes a group. Its Systems are moved to the default group.
+     * 
+     * \param hGroup A handle to the group to be removed. Must not be the
+     *               default group.
+     */
+    void removeGroup(GroupHandle hGroup)
+    {
+        auto it = std::find_if(groups_.begin() + 1, groups_.end(),
+                               [&](auto& g) { return g.get() == *hGroup; });
+        if (it == groups_.end())
+        { return; }
+
+        for (auto hSys : (*it)->systems())
+        { groups_.front()->insert(hSys, (*it)->phase(hSys)); }
+
+        groups_.erase(it);
+    }
+
+private:
+    std::vector<SystemGroupPtr_> groups_ = [](){
+        std::vector<SystemGroupPtr_> gs;
+        gs.push_back(std::make_unique<SystemGroup_>(Timestep::Variable));
+        return gs;
+    }();
+
+    SystemGroup_& groupOf_(SystemHandle hSys)
+    {
+        return **std::find_if(groups_.begin(), groups_.end(),
+                              [&](auto& g) { return g->contains(hSys); });
+    }
+
+public:
+    /**
+     * \brief Creates a new System attached to the types Us from the function f.
+     * 
+     * \param Us Set of types that the System is attached to.
+     * \param f  Function called to process entities. It must have the
+     *           following signature: (const std::set<Entity>&, Model&) -> void
+     * 
+     * \return A handle to the newly created System.
+     */
+    template <typename ... Us>
+    auto createSystem(System_::ProcessF f)
+    { return createSystem<Us ...>(f, defaultGroup()); }
+
+    /**
+     * \brief Creates a new System attached to the types Us from the function f
+     *        inside the group hGroup.
+     * 
+     * \param Us     Set of types that the System is attached to.
+     * \param f      Function called to process entities. It must have the
+     *               following signature: (const std::set<Entity>&, Model&) -> void
+     * \param hGroup The group in which the System is processed.
+     * \param phase  The phase of the System inside its group.
+     * 
+     * \return A handle to the newly created System.
+     */
+    template <typename ... Us>
+    auto createSystem(System_::ProcessF f, GroupHandle hGroup, Phase phase = Phase::Update)
+    { return addSystem_<Us ...>(f, hGroup, phase); }
+
+    /**
+     * \brief Creates a new System attached to the types Us from the coroutine
+     *        f, which can span multiple frames by awaiting "nextFrame()" or
+     *        "budget(d)". The entity set must not be iterated across
+     *        suspensions, as it may change between frames.
+     * 
+     * \param Us     Set of types that the System is attached to.
+     * \param f      Coroutine called to process entities. It must have the
+     *               following signature: (const std::set<Entity>&, Model&) -> SystemTask
+     * \param hGroup The group in which the System is processed.
+     * \param phase  The phase of the System inside its group.
+     * 
+     * \return A handle to the newly created System.
+     */
+    template <typename ... Us>
+    auto createCoroutineSystem(System_::CoroutineF f, GroupHandle hGroup, Phase phase = Phase::Update)
+    { return addSystem_<Us ...>(f, hGroup, phase); }
+
+    /**
+     * \brief Creates a new System attached to the types Us from the coroutine
+     *        f, inside the default group.
+     * 
+     * \param Us Set of types that the System is attached to.
+     * \param f  Coroutine called to process entities. It must have the
+     *           following signature: (const std::set<Entity>&, Model&) -> SystemTask
+     * 
+     * \return A handle to the newly created System.
+     */
+    template <typename ... Us>
+    auto createCoroutineSystem(System_::CoroutineF f)
+    { return createCoroutineSystem<Us ...>(f, defaultGroup()); }
+
+    /**
+     * \brief Removes a System.
+     * 
+     * \param hSys A handle to the System to be removed.
+     */
+    void removeSystem(SystemHandle hSys)
+    {
+        groupOf_(hSys).remove(hSys);
+        auto& sys = systems_.at(hSys);
+        auto unlist = [&](auto& systems) { std::erase(systems, sys.get()); };
+        if (sys->types().empty() && sys->dynamicTypes().empty())
+        { unlist(systemsByType_[sizeof...(Ts)]); }
+
+        for (auto t : sys->types())
+        { unlist(systemsByType_[t]); }
+
+        for (auto t : sys->dynamicTypes())
+        { unlist(systemsByDynamicType_[t]); }
+
+        systems_.erase(hSys);
+    }
+
+    /**
+     * \brief Attaches a System to a dynamic type, on top of the types it was
+     *        created with. Entities without data of this type leave it.
+     * 
+     * \param hSys A handle to the System.
+     * \param t    The dynamic type.
+     */
+    void attach(SystemHandle hSys, DynamicId t)
+    {
+        auto& sys = systems_.at(hSys);
+        if (sys->types().empty() && sys->dynamicTypes().empty())
+        { std::erase(systemsByType_[sizeof...(Ts)], sys.get()); }
+
+        sys->attach(t);
+        systemsByDynamicType_[t].push_back(sys.get());
+
+        for (auto e : spawnedEntities_)
+        {
+            if (!has(e, t))
+            { sys->remove(e); }
+        }
+    }
+
+    /**
+     * \brief Processes the entites. Publishes the events sent since the
+     *        last call, then calls "process(*this)" once to every created
+     *        Systems, regardless of their group's rate.
+     */
+    void process()
+    {
+        frameStep_ = 0.0;
+        startFrame_();
+        for (auto& g : groups_)
+        { g->processOnce(runSystem_(), jobs_.get()); }
+    }
+
+    /**
+     * \brief Processes the entites for a frame lasting dt seconds. Publishes
+     *        the events sent since the last call, then calls "process(*this)"
+     *        to the Systems of each group according to its rate.
+     * 
+     * \param dt Elapsed time since the last frame, in seconds.
+     */
+    void process(double dt)
+    {
+        frameStep_ = dt;
+        startFrame_();
+        for (auto& g : groups_)
+        { g->process(dt, runSystem_(), jobs_.get()); }
+    }
+
+    /**
+     * \brief Gets the time step of the System being processed: the fixed
+     *        step of a Fixed group, the time since its last call for an
+     *        Interval group, or the frame's elapsed time otherwise. The step
+     *        is known on the System's thread and inside "parallelEach";
+     *        elsewhere, such as in jobs submitted to "jobs()", this gives the
+     *        frame's elapsed time, so a System should pass its step to them.
+     * 
+     * \return The time step, in seconds.
+     */
+    double deltaTime() const
+    { return step_.model == this ? step_.dt : frameStep_; }
+
+    /**
+     * \brief Sets the time budget of coroutine Systems per call to "process".
+     *        Once it is exhausted, every "co_await budget(d)" suspends its
+     *        coroutine until the next frame.
+     * 
+     * \param d The time budget.
+     */
+    void setFrameBudget(TaskClock::duration d)
+    { frameBudget_ = d; }
+
+private:
+    std::map<SystemHandle, SystemPtr_> systems_;
+
+    // Systems listed under each static and dynamic type they are attached
+    // to, systems without any type being listed last. Changing one type of
+    // an Entity only visits the Systems listed under it.
+    std::array<std::vector<System_*>, sizeof...(Ts) + 1> systemsByType_;
+    std::vector<std::vector<System_*>> systemsByDynamicType_;
+
+    // Time step of the System running on this thread, the System itself
+    // for access checks, and of which Model.
+    struct Step_
+    {
+        const Model* model = nullptr;
+        double dt = 0.0;
+        System_* system = nullptr;
+    };
+
+    static inline thread_local Step_ step_;
+    double frameStep_ = 0.0;
+
+#if YOBECS_ACCESS_CHECKS
+    std::array<std::atomic<int>, sizeof...(Ts)> readers_ {};
+    std::array<std::atomic<int>, sizeof...(Ts)> writers_ {};
+
+    // Registers (d = 1) or unregisters (d = -1) the accesses of a running
+    // System, checking that no concurrent System conflicts with them.
+    void lockAccess_(System_& sys, int d)
+    {
+        auto writes = sys.writes();
+        (sys.reads() | writes).forEach([&](std::size_t i) {
+            if (writes[i])
+            {
+                auto w = writers_[i].fetch_add(d);
+                YOBECS_CHECK(d < 0 || (w == 0 && readers_[i] == 0),
+                             "concurrent Systems write the same Component");
+            }
+            else
+            {
+                readers_[i].fetch_add(d);
+                YOBECS_CHECK(d < 0 || writers_[i] == 0,
+                             "a System reads a Component written concurrently");
+            }
+        });
+    }
+
+    template <typename T>
+    void checkAccess_(bool write)
+    {
+        if (step_.model != this || !step_.system)
+        { return; }
+
+        auto writes = step_.system->writes();
+        auto allowed = write ? writes : step_.system->reads() | writes;
+        YOBECS_CHECK(allowed[typeId_<T>],
+                     "a System accesses a Component it did not declare");
+    }
+#endif
+
+    TaskClock::duration frameBudget_ = TaskClock::duration::max();
+    TaskClock::time_point frameDeadline_;
+
+    auto runSystem_()
+    {
+        return [this](SystemHandle hSys, double dt) {
+            auto prev = std::exchange(step_, Step_ { this, dt, *hSys });
+#if YOBECS_ACCESS_CHECKS
+            lockAccess_(**hSys, 1);
+#endif
+            (*hSys)->process(*this, frameDeadline_);
+#if YOBECS_ACCESS_CHECKS
+            lockAccess_(**hSys, -1);
+#endif
+            step_ = prev;
+        };
+    }
+
+    void startFrame_()
+    {
+        auto now = TaskClock::now();
+        frameDeadline_ = frameBudget_ < TaskClock::time_point::max() - now
+                       ? now + frameBudget_
+                       : TaskClock::time_point::max();
+        swapEvents_();
+    }
+
+    template <typename ... Us, typename F>
+    SystemHandle addSystem_(F f, GroupHandle hGroup, Phase phase)
+    {
+        auto tmpSys = std::make_unique<System_>(computeSignature_<Us ...>(), f);
+        SystemHandle hSys (tmpSys.get());
+        allowAccess<Us ...>(hSys);
+        auto& sys = systems_[hSys] = std::move(tmpSys);
+        (*hGroup)->insert(hSys, phase);
+
+        if (sys->types().empty())
+        { systemsByType_[sizeof...(Ts)].push_back(sys.get()); }
+
+        for (auto t : sys->types())
+        { systemsByType_[t].push_back(sys.get()); }
+
+        for (auto e : spawnedEntities_)
+        {
+            if (sys->matches(computeSignature_(e)))
+            { sys->insert(e); }
+        }
+
+        return hSys;
+    }
+
+    // Checks if e, of signature s, belongs to sys. Dynamic types are only
+    // looked up for the Systems attached to some.
+    bool matches_(const System_& sys, Entity e, const Signature_& s)
+    {
+        if (!sys.matches(s))
+        { return false; }
+
+        for (auto t : sys.dynamicTypes())
+        {
+            if (!has(e, t))
+            { return false; }
+        }
+
+        return true;
+    }
+
+    // Inserts e in the Systems it matches.
+    void insertInSystems_(Entity e)
+    {
+        const auto& s = computeSignature_(e);
+        for (auto& [_, sys] : systems_)
+        {
+            if (matches_(*sys, e, s))
+            { sys->insert(e); }
+        }
+    }
+
+    // Inserts e in the Systems listed under type t that it matches.
+    void insertInSystems_(Entity e, std::size_t t)
+    {
+        const auto& s = computeSignature_(e);
+        for (auto sys : systemsByType_[t])
+        {
+            if (matches_(*sys, e, s))
+            { sys->insert(e); }
+        }
+    }
+
+    // Removes e from the Systems listed under type t, which it no longer
+    // matches once it lost t.
+    void removeFromSystems_(Entity e, std::size_t t)
+    {
+        for (auto sys : systemsByType_[t])
+        { sys->remove(e); }
+    }
+
+/* SUB MODELS */
+public:
+    /**
+     * \brief Creates a System processing the inner Models of the Component
+     *        of type T, a SubModel, in parallel across the owning Entities.
+     *        Each inner Model is processed with the time step of the System
+     *        and shares the JobSystem of this Model. Inner Models must not
+     *        access the outer one.
+     * 
+     * \param T      The type of the Component, a SubModel.
+     * \param hGroup The group in which the System is processed.
+     * \param phase  The phase of the System inside its group.
+     * 
+     * \return A handle to the newly created System.
+     */
+    template <typename T>
+    SystemHandle createSubModelSystem(GroupHandle hGroup, Phase phase = Phase::Update)
+    {
+        static_assert(isSubModel<T>, "T must be a SubModel");
+
+        return createSystem<T>([](const std::set<Entity>&, Model& m) {
+            auto dt = m.deltaTime();
+            m.template parallelEach<T>([&](Entity, T& sub) {
+                if (!sub->jobs_)
+                { sub->jobs_ = m.jobs_; }
+
+                sub->process(dt);
+            }, 1);
+        }, hGroup, phase);
+    }
+
+    /**
+     * \brief Creates a System processing the inner Models of the Component
+     *        of type T, inside the default group.
+     * 
+     * \param T The type of the Component, a SubModel.
+     * 
+     * \return A handle to the newly created System.
+     */
+    template <typename T>
+    SystemHandle createSubModelSystem()
+    { return createSubModelSystem<T>(defaultGroup()); }
+
+private:
+    template <std::size_t, typename ...>
+    friend class Model;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,365 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \brief Enables NUMA placement through the Linux memory policy system
+ *        calls. Defaults to enabled on Linux; when disabled, the machine is
+ *        seen as a single node and placements are ignored.
+ */
+#ifndef YOBECS_NUMA
+#ifdef __linux__
+#define YOBECS_NUMA 1
+#else
+#define YOBECS_NUMA 0
+#endif
+#endif
+
+#if YOBECS_NUMA
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Where memory is placed on a NUMA machine, and whether large
+ *        allocations are backed by huge pages.
+ */
+struct Placement
+{
+    enum class Kind
+    {
+        /**
+         * \brief Where it is first touched, the system's default.
+         */
+        Default,
+
+        /**
+         * \brief Preferably on a given node.
+         */
+        Node,
+
+        /**
+         * \brief Interleaved page by page across every node, which evens out
+         *        the latency of large arrays read from every node.
+         */
+        Interleave
+    };
+
+    Kind kind = Kind::Default;
+    int node = 0;
+
+    /**
+     * \brief Backs allocations of at least numa::hugePageSize bytes with
+     *        huge pages, which reduces TLB misses when iterating over them.
+     */
+    bool hugePages = false;
+
+    /**
+     * \brief Places memory preferably on node n.
+     */
+    static Placement onNode(int n, bool huge = false)
+    { return { Kind::Node, n, huge }; }
+
+    /**
+     * \brief Interleaves memory across every node.
+     */
+    static Placement interleaved(bool huge = false)
+    { return { Kind::Interleave, 0, huge }; }
+
+    /**
+     * \brief Backs large allocations with huge pages, without NUMA placement.
+     */
+    static Placement huge()
+    { return { Kind::Default, 0, true }; }
+
+    bool operator==(const Placement&) const = default;
+};
+
+namespace numa {
+
+inline constexpr std::size_t pageSize = 4096;
+inline constexpr std::size_t hugePageSize = std::size_t(2) << 20;
+
+/**
+ * \brief Gets the alignment of an allocation of a given size, such that
+ *        large allocations can be backed by huge pages.
+ * 
+ * \param bytes The size of the allocation.
+ * 
+ * \return The alignment, which the size should be rounded to.
+ */
+inline constexpr std::size_t alignmentOf(std::size_t bytes)
+{ return bytes >= hugePageSize ? hugePageSize : pageSize; }
+
+// Parses a list of the form "0-3,8,10-11", as found in sysfs.
+inline std::vector<int> parseList_(const std::string& s)
+{
+    std::vector<int> l;
+    std::size_t i = 0;
+    while (i < s.size())
+    {
+        std::size_t end;
+        auto first = std::stoi(s.substr(i), &end);
+        i += end;
+        auto last = first;
+        if (i < s.size() && s[i] == '-')
+        {
+            last = std::stoi(s.substr(i + 1), &end);
+            i += end + 1;
+        }
+
+        for (auto k = first; k <= last; k++)
+        { l.push_back(k); }
+
+        while (i < s.size() && (s[i] == ',' || s[i] == '\n'))
+        { i++; }
+    }
+
+    return l;
+}
+
+inline std::vector<int> readList_(const std::string& path)
+{
+    std::ifstream f (path);
+    std::string s;
+    if (!std::getline(f, s) || s.empty())
+    { return {}; }
+
+    return parseList_(s);
+}
+
+/**
+ * \brief Gets the number of NUMA nodes of the machine.
+ * 
+ * \return The number of nodes, at least one.
+ */
+inline std::size_t nodeCount()
+{
+#if YOBECS_NUMA
+    static const auto n = [](){
+        auto nodes = readList_("/sys/devices/system/node/online");
+        return nodes.empty() ? std::size_t(1) : std::size_t(nodes.back() + 1);
+    }();
+    return n;
+#else
+    return 1;
+#endif
+}
+
+/**
+ * \brief Gets the CPUs of a NUMA node.
+ * 
+ * \param node The node.
+ * 
+ * \return The CPU numbers, empty if unknown.
+ */
+inline std::vector<int> cpusOf(int node)
+{
+#if YOBECS_NUMA
+    return readList_("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+#else
+    (void) node;
+    return {};
+#endif
+}
+
+/**
+ * \brief Asks for a range of memory to be backed by transparent huge pages.
+ * 
+ * \param p     The start of the range, aligned on hugePageSize.
+ * \param bytes The size of the range.
+ * 
+ * \return False if the system does not support it.
+ */
+inline bool adviseHugePages(void* p, std::size_t bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    return madvise(p, bytes, MADV_HUGEPAGE) == 0;
+#else
+    (void) p; (void) bytes;
+    return false;
+#endif
+}
+
+/**
+ * \brief Applies a placement to a page aligned range of memory. Pages
+ *        already touched are moved when possible. Huge pages are only asked
+ *        for ranges aligned on hugePageSize.
+ * 
+ * \param p     The start of the range, aligned on pageSize.
+ * \param bytes The size of the range.
+ * \param pl    The placement.
+ * 
+ * \return False if the placement could not be applied, for instance on a
+ *         system without NUMA or huge pages support.
+ */
+inline bool apply(void* p, std::size_t bytes, const Placement& pl)
+{
+    auto ok = true;
+    if (pl.hugePages && bytes >= hugePageSize && reinterpret_cast<std::uintptr_t>(p) % hugePageSize == 0)
+    { ok = adviseHugePages(p, bytes); }
+
+#if YOBECS_NUMA
+    if (pl.kind == Placement::Kind::Default || bytes == 0)
+    { return ok; }
+
+    constexpr auto bits = std::numeric_limits<unsigned long>::digits;
+    std::vector<unsigned long> mask ((nodeCount() + bits - 1) / bits);
+    auto set = [&](std::size_t n) { mask[n / bits] |= 1ul << (n % bits); };
+    if (pl.kind == Placement::Kind::Node)
+    {
+        if (pl.node < 0 || std::size_t(pl.node) >= nodeCount())
+        { return false; }
+        set(pl.node);
+    }
+    else
+    {
+        for (std::size_t n = 0; n < nodeCount(); n++)
+        { set(n); }
+    }
+
+    auto mode = pl.kind == Placement::Kind::Node ? MPOL_PREFERRED : MPOL_INTERLEAVE;
+    return syscall(SYS_mbind, p, bytes, mode, mask.data(), mask.size() * bits + 1, MPOL_MF_MOVE) == 0 && ok;
+#else
+    return pl.kind == Placement::Kind::Default && ok;
+#endif
+}
+
+/**
+ * \brief Restricts a thread to the CPUs of a NUMA node.
+ * 
+ * \param t    The thread.
+ * \param node The node.
+ * 
+ * \return False if the thread could not be restricted.
+ */
+inline bool pin(std::thread& t, int node)
+{
+#if YOBECS_NUMA
+    auto cpus = cpusOf(node);
+    if (cpus.empty())
+    { return false; }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto c : cpus)
+    { CPU_SET(c, &set); }
+
+    return pthread_setaffinity_np(t.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void) t; (void) node;
+    return false;
+#endif
+}
+
+}
+
+/**
+ * \brief Allocator following a Placement owned elsewhere, typically by a
+ *        Model. Without a Placement, it behaves as std::allocator. With one,
+ *        allocations are rounded to whole pages so that the policy only
+ *        covers them, and to whole huge pages when they are large enough.
+ * 
+ * \param T The type allocated.
+ */
+template <typename T>
+class PlacedAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    PlacedAllocator() = default;
+
+    /**
+     * \brief Creates an allocator following the placement pointed by p.
+     * 
+     * \param p The placement, which must outlive the allocator.
+     */
+    explicit PlacedAllocator(const Placement* p)
+    : placement_ { p }
+    {}
+
+    template <typename U>
+    PlacedAllocator(const PlacedAllocator<U>& o)
+    : placement_ { o.placement() }
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        if (!placement_)
+        { return std::allocator<T>().allocate(n); }
+
+        auto bytes = rounded_(n);
+        auto p = ::operator new(bytes, std::align_val_t(numa::alignmentOf(bytes)));
+        numa::apply(p, bytes, *placement_);
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        if (!placement_)
+        { return std::allocator<T>().deallocate(p, n); }
+
+        auto bytes = rounded_(n);
+        ::operator delete(p, bytes, std::align_val_t(numa::alignmentOf(bytes)));
+    }
+
+    const Placement* placement() const
+    { return placement_; }
+
+    template <typename U>
+    bool operator==(const PlacedAllocator<U>& o) const
+    { return placement_ == o.placement(); }
+
+private:
+    const Placement* placement_ = nullptr;
+
+    static std::size_t rounded_(std::size_t n)
+    {
+        auto a = numa::alignmentOf(n * sizeof(T));
+        return (n * sizeof(T) + a - 1) / a * a;
+    }
+};
+
+namespace numa {
+
+/**
+ * \brief Moves the elements of a vector of PlacedAllocator to a new buffer
+ *        following placement p, which the vector keeps following.
+ * 
+ * \param v The vector.
+ * \param p The placement, which must outlive the vector. Can be null.
+ */
+template <typename V>
+void rebind(V& v, const Placement* p)
+{
+    auto w = V(typename V::allocator_type(p));
+    w.reserve(v.size());
+    std::move(v.begin(), v.end(), std::back_inserter(w));
+    v = std::move(w);
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,468 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include "hash.hpp"
+#include "utils.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define YOBECS_SHM 1
+#else
+#define YOBECS_SHM 0
+#endif
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Layout of a shared memory segment holding the data of the
+ *        Components of types Ts, shared by its writer and its readers. Every
+ *        position is an offset from the start of the segment, so that each
+ *        process can map it anywhere.
+ * 
+ *        The segment starts with a header, followed by two buffers written in
+ *        turn. Each buffer holds, per type, the ids of the owners and their
+ *        data, then a table giving, per id and type, the offset of the data.
+ * 
+ * \param Ts The types of the Components, which must be trivially copyable.
+ */
+template <typename ... Ts>
+struct SharedLayout_
+{
+    static_assert(sizeof...(Ts) > 0, "A shared world needs at least one type");
+    static_assert((std::is_trivially_copyable_v<Ts> && ...), "Shared types must be trivially copyable");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared atomics must be lock free");
+
+    static constexpr std::size_t types = sizeof...(Ts);
+    static constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::size_t line = 64;
+
+    // Identifies the layout, so that readers do not map another one.
+    static constexpr std::uint64_t tag = [](){
+        std::uint64_t t = hashMix(types);
+        ((t = hashMix(t ^ (sizeof(Ts) << 16 | alignof(Ts)))), ...);
+        return t;
+    }();
+
+    struct Buffer
+    {
+        // Odd while the buffer is written.
+        std::atomic<std::uint64_t> seq;
+        std::uint64_t frame;
+        std::array<std::uint64_t, types> sizes;
+    };
+
+    struct Header
+    {
+        std::uint64_t tag;
+        std::uint64_t capacity;
+        std::atomic<std::uint64_t> frame;
+        std::array<Buffer, 2> buffers;
+    };
+
+    static constexpr std::array<std::size_t, types> sizes { sizeof(Ts) ... };
+
+    static constexpr std::size_t aligned(std::size_t n)
+    { return (n + line - 1) / line * line; }
+
+    static std::size_t bufferSize(std::size_t capacity)
+    {
+        std::size_t n = 0;
+        for (auto s : sizes)
+        { n += aligned(capacity * sizeof(std::uint64_t)) + aligned(capacity * s); }
+        return n + aligned(capacity * types * sizeof(std::uint32_t));
+    }
+
+    static std::size_t size(std::size_t capacity)
+    { return aligned(sizeof(Header)) + 2 * bufferSize(capacity); }
+
+    static std::size_t buffer(std::size_t capacity, std::size_t b)
+    { return aligned(sizeof(Header)) + b * bufferSize(capacity); }
+
+    static std::size_t ids(std::size_t capacity, std::size_t b, std::size_t i)
+    {
+        auto o = buffer(capacity, b);
+        for (std::size_t k = 0; k < i; k++)
+        { o += aligned(capacity * sizeof(std::uint64_t)) + aligned(capacity * sizes[k]); }
+        return o;
+    }
+
+    static std::size_t data(std::size_t capacity, std::size_t b, std::size_t i)
+    { return ids(capacity, b, i) + aligned(capacity * sizeof(std::uint64_t)); }
+
+    static std::size_t table(std::size_t capacity, std::size_t b)
+    { return ids(capacity, b, types); }
+
+    template <typename T>
+    static constexpr auto index = yobtk::utils::indexVariadicTypePack<T, Ts ...>;
+};
+
+/**
+ * \brief Owns a POSIX shared memory segment where a Model publishes the data
+ *        of the Components of types Ts every frame, through "Model::publish",
+ *        for SharedWorldReaders living in other processes. Entities are
+ *        identified by "Model::id". Publishing copies the data of a frame
+ *        into the buffer that readers are not reading, guarded by a seqlock,
+ *        so that readers see consistent frames without blocking the writer.
+ * 
+ * \param Ts The types of the Components, which must be trivially copyable.
+ */
+template <typename ... Ts>
+class SharedWorldWriter
+{
+private:
+    using Layout_ = SharedLayout_<Ts ...>;
+
+public:
+    /**
+     * \brief Creates the segment, replacing any segment of the same name.
+     * 
+     * \param name     The name of the segment, such as "/game-world".
+     * \param capacity The maximum number of data per type, and the upper
+     *                 bound of the ids of the Entities.
+     */
+    SharedWorldWriter(std::string name, std::size_t capacity)
+    : name_ { std::move(name) }
+    , capacity_ { capacity }
+    , size_ { Layout_::size(capacity) }
+    {
+#if YOBECS_SHM
+        shm_unlink(name_.c_str());
+        auto fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+        { return; }
+
+        if (ftruncate(fd, off_t(size_)) == 0)
+        {
+            auto p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED)
+            { base_ = static_cast<std::byte*>(p); }
+        }
+        close(fd);
+
+        if (!base_)
+        {
+            shm_unlink(name_.c_str());
+            return;
+        }
+
+        auto h = new (base_) typename Layout_::Header {};
+        h->tag = Layout_::tag;
+        h->capacity = capacity_;
+
+        // The tables start empty, every id being absent.
+        for (std::size_t b = 0; b < 2; b++)
+        { std::fill_n(table_(b), capacity_ * Layout_::types, Layout_::none); }
+#endif
+    }
+
+    SharedWorldWriter(const SharedWorldWriter&) = delete;
+    SharedWorldWriter& operator=(const SharedWorldWriter&) = delete;
+
+    /**
+     * \brief Unmaps and removes the segment. Readers keep their mapping.
+     */
+    ~SharedWorldWriter()
+    {
+#if YOBECS_SHM
+        if (base_)
+        {
+            munmap(base_, size_);
+            shm_unlink(name_.c_str());
+        }
+#endif
+    }
+
+    /**
+     * \brief Checks if the segment was created.
+     * 
+     * \return False on failure, or on systems without POSIX shared memory.
+     */
+    bool valid() const
+    { return base_ != nullptr; }
+
+    /**
+     * \brief Gets the maximum number of data per type.
+     * 
+     * \return The capacity.
+     */
+    std::size_t capacity() const
+    { return capacity_; }
+
+    /**
+     * \brief Gets the number of the last published frame.
+     * 
+     * \return The frame number, 0 before the first one.
+     */
+    std::uint64_t frame() const
+    { return header_()->frame.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Starts writing the next frame into the buffer readers are not
+     *        reading, emptying it. Used by "Model::publish".
+     */
+    void beginFrame()
+    {
+        auto& buf = buffer_();
+        buf.seq.store(buf.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // Only the table entries of the data the buffer held are cleared.
+        auto table = table_(back_());
+        for (std::size_t i = 0; i < Layout_::types; i++)
+        {
+            auto ids = ids_(back_(), i);
+            for (std::size_t k = 0; k < buf.sizes[i]; k++)
+            { table[ids[k] * Layout_::types + i] = Layout_::none; }
+            buf.sizes[i] = 0;
+        }
+    }
+
+    /**
+     * \brief Appends the data of an Entity to the frame being written.
+     * 
+     * \param T   The type of the data.
+     * \param id  The identifier of the Entity, lower than the capacity.
+     * \param val The data.
+     * 
+     * \return False if the type is full or the id too large.
+     */
+    template <typename T>
+    bool append(std::uint64_t id, const T& val)
+    {
+        constexpr auto i = Layout_::template index<T>;
+        auto& size = buffer_().sizes[i];
+        if (size >= capacity_ || id >= capacity_)
+        { return false; }
+
+        ids_(back_(), i)[size] = id;
+        std::memcpy(base_ + Layout_::data(capacity_, back_(), i) + size * sizeof(T), &val, sizeof(T));
+        table_(back_())[id * Layout_::types + i] = std::uint32_t(size);
+        size++;
+        return true;
+    }
+
+    /**
+     * \brief Ends the frame being written, which readers see from then on.
+     * 
+     * \param publish False to drop the frame, for instance when it did not
+     *                fit, in which case readers keep seeing the previous one.
+     */
+    void endFrame(bool publish = true)
+    {
+        auto& buf = buffer_();
+        auto f = frame() + 1;
+        buf.frame = f;
+        buf.seq.store(buf.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        if (publish)
+        { header_()->frame.store(f, std::memory_order_release); }
+    }
+
+private:
+    std::string name_;
+    std::size_t capacity_;
+    std::size_t size_;
+    std::byte* base_ = nullptr;
+
+    typename Layout_::Header* header_() const
+    { return std::launder(reinterpret_cast<typename Layout_::Header*>(base_)); }
+
+    // The buffer of the next frame.
+    std::size_t back_() const
+    { return (frame() + 1) % 2; }
+
+    typename Layout_::Buffer& buffer_()
+    { return header_()->buffers[back_()]; }
+
+    std::uint64_t* ids_(std::size_t b, std::size_t i)
+    { return reinterpret_cast<std::uint64_t*>(base_ + Layout_::ids(capacity_, b, i)); }
+
+    std::uint32_t* table_(std::size_t b)
+    { return reinterpret_cast<std::uint32_t*>(base_ + Layout_::table(capacity_, b)); }
+};
+
+/**
+ * \brief Maps, read only, the segment of a SharedWorldWriter created by
+ *        another process, and reads its frames in place.
+ * 
+ * \param Ts The types of the Components, the same as the writer's.
+ */
+template <typename ... Ts>
+class SharedWorldReader
+{
+private:
+    using Layout_ = SharedLayout_<Ts ...>;
+
+public:
+    /**
+     * \brief Represents a published frame, read in place.
+     */
+    class View
+    {
+    public:
+        /**
+         * \brief Gets the number of the frame.
+         */
+        std::uint64_t frame() const
+        { return buf_->frame; }
+
+        /**
+         * \brief Gets the data of type T of the frame.
+         */
+        template <typename T>
+        std::span<const T> data() const
+        {
+            constexpr auto i = Layout_::template index<T>;
+            return { reinterpret_cast<const T*>(base_ + Layout_::data(capacity_, b_, i)), buf_->sizes[i] };
+        }
+
+        /**
+         * \brief Gets the ids of the owners of the data of type T, in the
+         *        same order as "data<T>()".
+         */
+        template <typename T>
+        std::span<const std::uint64_t> ids() const
+        {
+            constexpr auto i = Layout_::template index<T>;
+            return { reinterpret_cast<const std::uint64_t*>(base_ + Layout_::ids(capacity_, b_, i)), buf_->sizes[i] };
+        }
+
+        /**
+         * \brief Finds the data of type T of an Entity.
+         * 
+         * \param id The identifier of the Entity.
+         * 
+         * \return A pointer to the data, or nullptr if it has none.
+         */
+        template <typename T>
+        const T* find(std::uint64_t id) const
+        {
+            constexpr auto i = Layout_::template index<T>;
+            if (id >= capacity_)
+            { return nullptr; }
+
+            auto table = reinterpret_cast<const std::uint32_t*>(base_ + Layout_::table(capacity_, b_));
+            auto k = table[id * Layout_::types + i];
+            return k < buf_->sizes[i] ? data<T>().data() + k : nullptr;
+        }
+
+    private:
+        friend SharedWorldReader;
+
+        const std::byte* base_;
+        std::size_t capacity_;
+        std::size_t b_;
+        const typename Layout_::Buffer* buf_;
+    };
+
+    /**
+     * \brief Maps the segment of a writer.
+     * 
+     * \param name The name of the segment.
+     */
+    explicit SharedWorldReader(const std::string& name)
+    {
+#if YOBECS_SHM
+        auto fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+        { return; }
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && std::size_t(st.st_size) >= sizeof(typename Layout_::Header))
+        {
+            auto p = mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                base_ = static_cast<const std::byte*>(p);
+                size_ = std::size_t(st.st_size);
+            }
+        }
+        close(fd);
+
+        if (base_ && (header_()->tag != Layout_::tag || Layout_::size(header_()->capacity) != size_))
+        {
+            munmap(const_cast<std::byte*>(base_), size_);
+            base_ = nullptr;
+        }
+#else
+        (void) name;
+#endif
+    }
+
+    SharedWorldReader(const SharedWorldReader&) = delete;
+    SharedWorldReader& operator=(const SharedWorldReader&) = delete;
+
+    ~SharedWorldReader()
+    {
+#if YOBECS_SHM
+        if (base_)
+        { munmap(const_cast<std::byte*>(base_), size_); }
+#endif
+    }
+
+    /**
+     * \brief Checks if a segment of the same types was mapped.
+     * 
+     * \return False if there is no such segment.
+     */
+    bool valid() const
+    { return base_ != nullptr; }
+
+    /**
+     * \brief Calls f on the last published frame. If the writer overwrote
+     *        the frame meanwhile, f is called again on a newer one, so f must
+     *        only keep what it computed during its last call.
+     * 
+     * \param f Function called on the frame: (const View&) -> void
+     * 
+     * \return False if no frame was published yet.
+     */
+    template <typename F>
+    bool read(F&& f)
+    {
+        while (true)
+        {
+            auto frame = header_()->frame.load(std::memory_order_acquire);
+            if (frame == 0)
+            { return false; }
+
+            auto& buf = header_()->buffers[frame % 2];
+            auto seq = buf.seq.load(std::memory_order_acquire);
+            if (seq % 2 != 0)
+            { continue; }
+
+            View v;
+            v.base_ = base_;
+            v.capacity_ = header_()->capacity;
+            v.b_ = frame % 2;
+            v.buf_ = &buf;
+            f(std::as_const(v));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (buf.seq.load(std::memory_order_relaxed) == seq)
+            { return true; }
+        }
+    }
+
+private:
+    const std::byte* base_ = nullptr;
+    std::size_t size_ = 0;
+
+    const typename Layout_::Header* header_() const
+    { return std::launder(reinterpret_cast<const typename Layout_::Header*>(base_)); }
+};
+
+}
\ No newline at end of file
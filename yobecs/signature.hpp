@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Represents a set of Component's types, as presence bits packed in
+ *        64 bits words. Operations work word by word, which compilers turn
+ *        into vector instructions for large sets.
+ * 
+ * \param P Number of presence bits.
+ */
+template <std::size_t P>
+class Signature
+{
+public:
+    /**
+     * \brief Sets or clears the b-th bit.
+     * 
+     * \param b The bit number.
+     * \param v The new value of the bit.
+     * 
+     * \return A reference to the signature.
+     */
+    constexpr Signature& set(std::size_t b, bool v = true)
+    {
+        auto m = std::uint64_t(1) << (b % 64);
+        words_[b / 64] = v ? words_[b / 64] | m : words_[b / 64] & ~m;
+        return *this;
+    }
+
+    /**
+     * \brief Checks the b-th bit.
+     * 
+     * \param b The bit number.
+     * 
+     * \return The value of the bit.
+     */
+    constexpr bool operator[](std::size_t b) const
+    { return (words_[b / 64] >> (b % 64)) & 1; }
+
+    /**
+     * \brief Checks if every bit of s is set in this signature.
+     * 
+     * \param s The signature of interest.
+     * 
+     * \return A boolean answering the check.
+     */
+    constexpr bool contains(const Signature& s) const
+    {
+        std::uint64_t missing = 0;
+        for (std::size_t w = 0; w < wordCount; w++)
+        { missing |= s.words_[w] & ~words_[w]; }
+        return missing == 0;
+    }
+
+    /**
+     * \brief Calls f on the number of each set bit, in increasing order.
+     * 
+     * \param f Function called on each bit number: (std::size_t) -> void
+     */
+    template <typename F>
+    constexpr void forEach(F&& f) const
+    {
+        for (std::size_t w = 0; w < wordCount; w++)
+        {
+            for (auto word = words_[w]; word != 0; word &= word - 1)
+            { f(w * 64 + std::countr_zero(word)); }
+        }
+    }
+
+    /**
+     * \brief Lists the numbers of the set bits, in increasing order.
+     * 
+     * \return The bit numbers.
+     */
+    std::vector<std::size_t> list() const
+    {
+        std::vector<std::size_t> l;
+        forEach([&](std::size_t b) { l.push_back(b); });
+        return l;
+    }
+
+    constexpr Signature& operator|=(const Signature& s)
+    {
+        for (std::size_t w = 0; w < wordCount; w++)
+        { words_[w] |= s.words_[w]; }
+        return *this;
+    }
+
+    constexpr Signature& operator&=(const Signature& s)
+    {
+        for (std::size_t w = 0; w < wordCount; w++)
+        { words_[w] &= s.words_[w]; }
+        return *this;
+    }
+
+    friend constexpr Signature operator|(Signature a, const Signature& b)
+    { return a |= b; }
+
+    friend constexpr Signature operator&(Signature a, const Signature& b)
+    { return a &= b; }
+
+    friend constexpr bool operator==(const Signature&, const Signature&) = default;
+
+    /**
+     * \brief Number of 64 bits words of a signature.
+     */
+    static constexpr std::size_t wordCount = P / 64 + (P % 64 != 0 || P == 0);
+
+private:
+    std::array<std::uint64_t, wordCount> words_ {};
+};
+
+}
\ No newline at end of file
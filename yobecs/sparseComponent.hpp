@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "numa.hpp"
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Represents a Component whose data is found through an open
+ *        addressing hash map keyed by the slot number of its owner. Data is
+ *        grouped inside a contiguous vector, so that iterating skips the map.
+ * 
+ * \param T The type used.
+ */
+template <typename T>
+class SparseComponent
+{
+public:
+    /**
+     * \brief Inserts the data of slot s with value val.
+     * 
+     * \param s   The slot.
+     * \param val An optional default value, moved into the component.
+     */
+    void insert(std::size_t s, T val = {})
+    {
+        if (2 * (data_.size() + 1) > keys_.size())
+        { rehash_(std::max<std::size_t>(16, 2 * keys_.size())); }
+
+        auto p = probe_(s);
+        keys_[p] = s;
+        offsets_[p] = data_.size();
+        data_.push_back(std::move(val));
+        owners_.push_back(s);
+    }
+
+    /**
+     * \brief Removes the data of slot s.
+     * 
+     * \param s The slot.
+     */
+    void remove(std::size_t s)
+    {
+        auto p = probe_(s);
+        auto a = offsets_[p];
+        erase_(p);
+
+        if (a + 1 < data_.size())
+        {
+            data_[a] = std::move(data_.back());
+            owners_[a] = owners_.back();
+            offsets_[probe_(owners_[a])] = a;
+        }
+
+        data_.pop_back();
+        owners_.pop_back();
+    }
+
+    /**
+     * \brief Gives the data of slot from to the free slot to, without moving
+     *        the data itself.
+     * 
+     * \param from The slot having data.
+     * \param to   The slot receiving it.
+     */
+    void relocate(std::size_t from, std::size_t to)
+    {
+        auto p = probe_(from);
+        auto a = offsets_[p];
+        erase_(p);
+
+        auto q = probe_(to);
+        keys_[q] = to;
+        offsets_[q] = a;
+        owners_[a] = to;
+    }
+
+    /**
+     * \brief Accesses the data of slot s.
+     * 
+     * \param s The slot.
+     * 
+     * \return A reference to the data.
+     */
+    auto& access(std::size_t s)
+    { return data_[offsets_[probe_(s)]]; }
+
+    /**
+     * \brief Accesses the data at offset a of the contiguous vector.
+     * 
+     * \param a The offset.
+     * 
+     * \return A reference to the data.
+     */
+    auto& at(std::size_t a)
+    { return data_[a]; }
+
+    /**
+     * \brief Gets the slot owning the data at offset a.
+     * 
+     * \param a The offset.
+     * 
+     * \return The slot.
+     */
+    auto owner(std::size_t a) const
+    { return owners_[a]; }
+
+    /**
+     * \brief Gets the number of stored data.
+     * 
+     * \return The number of stored data.
+     */
+    auto size() const
+    { return data_.size(); }
+
+    /**
+     * \brief Makes the data follow a placement, moving it to a new buffer.
+     * 
+     * \param p The placement, which must outlive the component. Can be null.
+     */
+    void place(const Placement* p)
+    { numa::rebind(data_, p); }
+
+private:
+    static constexpr auto empty_ = std::numeric_limits<std::size_t>::max();
+
+    std::vector<std::size_t> keys_;
+    std::vector<std::size_t> offsets_;
+    std::vector<T, PlacedAllocator<T>> data_;
+    std::vector<std::size_t> owners_;
+
+    std::size_t home_(std::size_t s) const
+    {
+        // Fibonacci hashing spreads consecutive slots over the table.
+        auto bits = std::countr_zero(keys_.size());
+        return (std::uint64_t(s) * 11400714819323198485ull) >> (64 - bits);
+    }
+
+    // Position of slot s, or of the empty bucket where it would go.
+    std::size_t probe_(std::size_t s) const
+    {
+        auto mask = keys_.size() - 1;
+        auto p = home_(s);
+        while (keys_[p] != empty_ && keys_[p] != s)
+        { p = (p + 1) & mask; }
+        return p;
+    }
+
+    // Backward shift deletion, keeping probe sequences without tombstones.
+    void erase_(std::size_t p)
+    {
+        auto mask = keys_.size() - 1;
+        for (auto q = (p + 1) & mask; keys_[q] != empty_; q = (q + 1) & mask)
+        {
+            auto h = home_(keys_[q]);
+            if (((q - h) & mask) >= ((q - p) & mask))
+            {
+                keys_[p] = keys_[q];
+                offsets_[p] = offsets_[q];
+                p = q;
+            }
+        }
+
+        keys_[p] = empty_;
+    }
+
+    void rehash_(std::size_t capacity)
+    {
+        keys_.assign(capacity, empty_);
+        offsets_.assign(capacity, 0);
+        for (std::size_t a = 0; a < owners_.size(); a++)
+        {
+            auto p = probe_(owners_[a]);
+            keys_[p] = owners_[a];
+            offsets_[p] = a;
+        }
+    }
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "utils.hpp"
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Represents Entities and their data prepared outside of a Model, for
+ *        instance on a background thread, to be committed in bulk later.
+ *        Entities are local indices until the commit.
+ * 
+ * \param Ts List of types used in Components (must all be different).
+ */
+template <typename ... Ts>
+class Staging
+{
+public:
+    /**
+     * \brief Data staged for the Component of type T.
+     * 
+     * \param T The type of the Component.
+     */
+    template <typename T>
+    struct Column
+    {
+        std::vector<std::size_t> entities;
+        std::vector<T> data;
+    };
+
+    /**
+     * \brief Creates a new local Entity.
+     * 
+     * \return The index of the local Entity.
+     */
+    std::size_t createEntity()
+    { return count_++; }
+
+    /**
+     * \brief Stages data of type T for the local Entity i. Each Entity can
+     *        receive at most one data per type.
+     * 
+     * \param T   The type of the Component.
+     * \param i   The local Entity.
+     * \param val An optional default value, moved into the Staging.
+     */
+    template <typename T>
+    void insert(std::size_t i, T val = {})
+    {
+        auto& c = column<T>();
+        c.entities.push_back(i);
+        c.data.push_back(std::move(val));
+    }
+
+    /**
+     * \brief Preallocates room for n data of type T.
+     * 
+     * \param T The type of the Component.
+     * \param n The number of data.
+     */
+    template <typename T>
+    void reserve(std::size_t n)
+    {
+        auto& c = column<T>();
+        c.entities.reserve(n);
+        c.data.reserve(n);
+    }
+
+    /**
+     * \brief Gets the number of local Entities.
+     * 
+     * \return The number of local Entities.
+     */
+    std::size_t size() const
+    { return count_; }
+
+    /**
+     * \brief Removes every local Entity and staged data, keeping the
+     *        allocated memory.
+     */
+    void clear()
+    {
+        count_ = 0;
+        (clear_(column<Ts>()), ...);
+    }
+
+    /**
+     * \brief Accesses the data staged for the Component of type T.
+     * 
+     * \param T The type of the Component.
+     * 
+     * \return A reference to the column.
+     */
+    template <typename T>
+    auto& column()
+    { return yobtk::utils::get<yobtk::utils::indexVariadicTypePack<T, Ts ...>>(columns_); }
+
+private:
+    std::size_t count_ = 0;
+    yobtk::utils::FlatTuple<Column<Ts> ...> columns_;
+
+    template <typename T>
+    static void clear_(Column<T>& c)
+    {
+        c.entities.clear();
+        c.data.clear();
+    }
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace yobtk::ecs {
+
+/**
+ * \brief How the data of a Component is stored.
+ */
+enum class Storage
+{
+    /**
+     * \brief In a contiguous vector, found through an offset stored in the
+     *        Entity's row of the AccessMatrix. Default policy.
+     */
+    Dense,
+
+    /**
+     * \brief Directly inside the Entity's row of the AccessMatrix, packed with
+     *        the other Inline types. There is no offset nor owner to store and
+     *        no data to move on removal. Reserved to small trivially copyable
+     *        types, such as flags, team ids or enums.
+     */
+    Inline,
+
+    /**
+     * \brief In a vector indexed by the Entity's slot number, with holes for
+     *        the Entities without data. Suited to types that almost every
+     *        Entity has, such as transforms.
+     */
+    Direct,
+
+    /**
+     * \brief In a contiguous vector, found through a hash map keyed by the
+     *        Entity's slot number. There is no offset to store in the
+     *        AccessMatrix, which suits types that very few Entities have.
+     */
+    Sparse
+};
+
+/**
+ * \brief Declares, in the types of a Model, that the Component of type T uses
+ *        the Inline storage policy.
+ * 
+ * \param T The Component's type.
+ */
+template <typename T>
+struct Inline {};
+
+/**
+ * \brief Declares, in the types of a Model, that the Component of type T uses
+ *        the Direct storage policy.
+ * 
+ * \param T The Component's type.
+ */
+template <typename T>
+struct Direct {};
+
+/**
+ * \brief Declares, in the types of a Model, that the Component of type T uses
+ *        the Sparse storage policy.
+ * 
+ * \param T The Component's type.
+ */
+template <typename T>
+struct Sparse {};
+
+template <typename T>
+struct _storageOf
+{
+    using type = T;
+    static constexpr auto policy = Storage::Dense;
+};
+
+template <typename T>
+struct _storageOf<Inline<T>>
+{
+    using type = T;
+    static constexpr auto policy = Storage::Inline;
+};
+
+template <typename T>
+struct _storageOf<Direct<T>>
+{
+    using type = T;
+    static constexpr auto policy = Storage::Direct;
+};
+
+template <typename T>
+struct _storageOf<Sparse<T>>
+{
+    using type = T;
+    static constexpr auto policy = Storage::Sparse;
+};
+
+/**
+ * \brief The Component's type declared by T, with any storage policy removed.
+ */
+template <typename T>
+using ComponentType = typename _storageOf<T>::type;
+
+/**
+ * \brief The storage policy declared by T.
+ */
+template <typename T>
+static constexpr auto storagePolicy = _storageOf<T>::policy;
+
+/**
+ * \brief Checks if a type can use the Inline storage policy: it must be
+ *        trivially copyable and fit in an offset of the AccessMatrix.
+ */
+template <typename T>
+concept InlineStorable = std::is_trivially_copyable_v<T>
+                      && sizeof(T) <= sizeof(std::size_t)
+                      && alignof(T) <= alignof(std::size_t);
+
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Represents an inner Model owned by an Entity of an outer Model, to
+ *        be used as a Component's type. The inner Model lives on the heap so
+ *        that the Component can move its data around.
+ * 
+ * \param M The inner Model's type.
+ */
+template <typename M>
+class SubModel
+{
+public:
+    /**
+     * \brief The inner Model's type.
+     */
+    using Model = M;
+
+    /**
+     * \brief Creates an empty inner Model.
+     */
+    SubModel()
+    : model_ { std::make_unique<M>() }
+    {}
+
+    /**
+     * \brief Accesses the inner Model.
+     * 
+     * \return A reference to the inner Model.
+     */
+    M& operator*()
+    { return *model_; }
+
+    /**
+     * \brief Accesses the inner Model.
+     * 
+     * \return A pointer to the inner Model.
+     */
+    M* operator->()
+    { return model_.get(); }
+
+private:
+    std::unique_ptr<M> model_;
+};
+
+/**
+ * \brief Checks if a type is a SubModel.
+ */
+template <typename T>
+static constexpr bool isSubModel = false;
+
+template <typename M>
+static constexpr bool isSubModel<SubModel<M>> = true;
+
+}
\ No newline at end of file
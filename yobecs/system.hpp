@@ -2,6 +2,10 @@
 
 #include <set>
 #include <functional>
+#include <vector>
+
+#include "accessCheck.hpp"
+#include "systemTask.hpp"
 
 namespace yobtk::ecs {
 
@@ -21,7 +25,12 @@ public:
      * \brief Process function signature.
      */
     using ProcessF = std::function<void(const std::set<E>&, M&)>;
-    
+
+    /**
+     * \brief Coroutine process function signature.
+     */
+    using CoroutineF = std::function<SystemTask(const std::set<E>&, M&)>;
+
     /**
      * \brief Creates a System.
      * 
@@ -31,9 +40,25 @@ public:
      */
     System(S signature, ProcessF f)
     : signature_ { signature }
+    , types_ { signature.list() }
     , f_ { f }
     {}
 
+    /**
+     * \brief Creates a System whose process function is a coroutine, which
+     *        can span multiple frames. A new coroutine is started on the
+     *        frame following the completion of the previous one.
+     * 
+     * \param signature System's signature.
+     * \param f Coroutine process function. Must have the following signature:
+     *          (const std::set<Entity>&, Model&) -> SystemTask
+     */
+    System(S signature, CoroutineF f)
+    : signature_ { signature }
+    , types_ { signature.list() }
+    , coroutineF_ { f }
+    {}
+
     /**
      * \brief Gets the system's signature.
      * 
@@ -42,6 +67,85 @@ public:
     S signature()
     { return signature_; }
 
+    /**
+     * \brief Gets the numbers of the types in the system's signature.
+     * 
+     * \return The type numbers, in increasing order.
+     */
+    const auto& types() const
+    { return types_; }
+
+    /**
+     * \brief Checks if an entity of signature s belongs to the system. A
+     *        system with few types tests them one by one, so the cost does
+     *        not depend on the total number of types, while a system with
+     *        more types than the signature has words compares it word by word.
+     * 
+     * \param s The entity's signature.
+     * 
+     * \return A boolean answering the check.
+     */
+    bool matches(const S& s) const
+    {
+        if (types_.size() > S::wordCount)
+        { return s.contains(signature_); }
+
+        for (auto t : types_)
+        {
+            if (!s[t])
+            { return false; }
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Gets the dynamic types the system is attached to, on top of its
+     *        signature.
+     * 
+     * \return The dynamic type numbers.
+     */
+    const auto& dynamicTypes() const
+    { return dynamicTypes_; }
+
+    /**
+     * \brief Attaches the system to a dynamic type.
+     * 
+     * \param t The dynamic type number.
+     */
+    void attach(std::size_t t)
+    { dynamicTypes_.push_back(t); }
+
+#if YOBECS_ACCESS_CHECKS
+    /**
+     * \brief Allows the system to access more data.
+     * 
+     * \param reads  Signature of the data read.
+     * \param writes Signature of the data written, must be part of reads.
+     */
+    void allow(S reads, S writes)
+    {
+        reads_ |= reads;
+        writes_ |= writes;
+    }
+
+    /**
+     * \brief Gets the signature of the data the system may read.
+     * 
+     * \return The signature.
+     */
+    S reads() const
+    { return reads_; }
+
+    /**
+     * \brief Gets the signature of the data the system may write.
+     * 
+     * \return The signature.
+     */
+    S writes() const
+    { return writes_; }
+#endif
+
     /**
      * \brief Inserts an entity in the set.
      */
@@ -58,14 +162,35 @@ public:
      * \brief Processes the entity set.
      * 
      * \param m The model so that the process function have access to the entities' data.
+     * \param frameDeadline Time after which the budget of a coroutine
+     *                      process function is exhausted.
      */
-    void process(M& m)
-    { f_(entities_, m); }
+    void process(M& m, TaskClock::time_point frameDeadline = TaskClock::time_point::max())
+    {
+        if (!coroutineF_)
+        {
+            f_(entities_, m);
+            return;
+        }
+
+        if (!task_)
+        { task_ = coroutineF_(entities_, m); }
+
+        task_.resume(frameDeadline);
+    }
 
 private:
     S signature_;
+    std::vector<std::size_t> types_;
+    std::vector<std::size_t> dynamicTypes_;
     std::set<E> entities_;
     ProcessF f_;
+    CoroutineF coroutineF_;
+    SystemTask task_;
+#if YOBECS_ACCESS_CHECKS
+    S reads_;
+    S writes_;
+#endif
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,434 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "jobSystem.hpp"
+
+namespace yobtk::ecs {
+
+/**
+ * \brief How a SystemGroup converts elapsed time into System calls.
+ */
+enum class Timestep
+{
+    /**
+     * \brief Every System is called once per frame with the frame's
+     *        elapsed time.
+     */
+    Variable,
+
+    /**
+     * \brief Every System is called once per fixed step of 1/rate seconds,
+     *        as many times as needed to catch up with the elapsed time.
+     */
+    Fixed,
+
+    /**
+     * \brief Every System is called at most once per frame, when 1/rate
+     *        seconds elapsed since its last call. Calls are staggered across
+     *        frames so that the Systems of the group do not run all at once.
+     */
+    Interval
+};
+
+/**
+ * \brief Named phases ordering the Systems of a group. Every System of a
+ *        phase is processed before the Systems of the following phases.
+ */
+enum class Phase
+{
+    PreUpdate,
+    Update,
+    PostUpdate
+};
+
+/**
+ * \brief Represents a group of Systems sharing the same rate. Systems are
+ *        processed by phase, then following the explicit constraints between
+ *        them, then by insertion order. This order is computed once per
+ *        change and cached.
+ * 
+ * \param H System handle type.
+ */
+template <typename H>
+class SystemGroup
+{
+public:
+    /**
+     * \brief Creates a SystemGroup.
+     * 
+     * \param timestep How elapsed time is converted into System calls.
+     * \param rate     Number of calls per second. Ignored for Variable groups;
+     *                 a group without a positive rate is Variable.
+     * \param maxSteps Maximum number of steps per frame of a Fixed group.
+     *                 Extra time is dropped to avoid a spiral of death.
+     */
+    SystemGroup(Timestep timestep, double rate = 0.0, std::size_t maxSteps = 8)
+    : timestep_ { rate > 0.0 ? timestep : Timestep::Variable }
+    , period_ { rate > 0.0 ? 1.0 / rate : 0.0 }
+    , maxSteps_ { maxSteps }
+    {}
+
+    /**
+     * \brief Inserts a System at the end of its phase.
+     * 
+     * \param h     The System's handle.
+     * \param phase The System's phase.
+     */
+    void insert(H h, Phase phase = Phase::Update)
+    {
+        members_.push_back({ h, stagger_(nextSeq_), phase, nextSeq_ });
+        nextSeq_++;
+        sort_();
+    }
+
+    /**
+     * \brief Removes a System from the group.
+     * 
+     * \param h The System's handle.
+     * 
+     * \return A boolean indicating if the System was part of the group.
+     */
+    bool remove(H h)
+    {
+        auto it = find_(h);
+        if (it == members_.end())
+        { return false; }
+
+        members_.erase(it);
+        std::erase_if(edges_, [h](const auto& e) { return e.first == h || e.second == h; });
+        computeWaves_();
+        return true;
+    }
+
+    /**
+     * \brief Checks if a System is part of the group.
+     * 
+     * \param h The System's handle.
+     * 
+     * \return A boolean answering the check.
+     */
+    bool contains(H h) const
+    { return find_(h) != members_.end(); }
+
+    /**
+     * \brief Gets the phase of a System of the group.
+     * 
+     * \param h The System's handle.
+     * 
+     * \return The System's phase.
+     */
+    Phase phase(H h) const
+    { return find_(h)->phase; }
+
+    /**
+     * \brief Changes the phase of a System of the group.
+     * 
+     * \param h     The System's handle.
+     * \param phase The new phase.
+     * 
+     * \return False if the phase contradicts an ordering constraint, in
+     *         which case nothing is changed.
+     */
+    bool setPhase(H h, Phase phase)
+    {
+        auto old = std::exchange(find_(h)->phase, phase);
+        if (!sort_())
+        {
+            find_(h)->phase = old;
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Constrains a System to be processed before another one.
+     * 
+     * \param first  The handle of the System processed first.
+     * \param second The handle of the System processed second.
+     * 
+     * \return False if the constraint creates a cycle or contradicts the
+     *         phases, in which case it is discarded.
+     */
+    bool order(H first, H second)
+    {
+        edges_.emplace_back(first, second);
+        if (!sort_())
+        {
+            edges_.pop_back();
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Allows the Systems of the group to be processed in parallel.
+     *        Systems of the same phase that are not ordered by a constraint
+     *        may then run concurrently, so they must not modify the same data
+     *        nor create or remove Entities and Systems.
+     * 
+     * \param parallel A boolean enabling or disabling parallel processing.
+     */
+    void setParallel(bool parallel)
+    { parallel_ = parallel; }
+
+    /**
+     * \brief Advances the group by dt seconds and calls the due Systems.
+     * 
+     * \param dt   Elapsed time since the last frame, in seconds.
+     * \param run  Function called for each System call: (H, double) -> void,
+     *             the second parameter being the time step of the call.
+     * \param jobs The JobSystem used if the group is parallel, or nullptr.
+     */
+    template <typename F>
+    void process(double dt, F&& run, JobSystem* jobs = nullptr)
+    {
+        switch (timestep_)
+        {
+        case Timestep::Variable:
+            scheduleAll_(dt);
+            runDue_(run, jobs);
+            break;
+
+        case Timestep::Fixed:
+        {
+            acc_ += dt;
+            std::size_t steps = 0;
+            for (; acc_ >= period_ && steps < maxSteps_; steps++)
+            {
+                acc_ -= period_;
+                scheduleAll_(period_);
+                runDue_(run, jobs);
+            }
+
+            if (steps == maxSteps_)
+            { acc_ = std::fmod(acc_, period_); }
+            break;
+        }
+
+        case Timestep::Interval:
+            for (auto& m : members_)
+            {
+                m.acc += dt;
+                m.elapsed += dt;
+                m.due = m.acc >= period_;
+                if (m.due)
+                {
+                    m.step = std::exchange(m.elapsed, 0.0);
+                    m.acc = std::fmod(m.acc, period_);
+                }
+            }
+            runDue_(run, jobs);
+            break;
+        }
+    }
+
+    /**
+     * \brief Calls every System of the group once, regardless of its rate.
+     * 
+     * \param run  Function called for each System call: (H, double) -> void,
+     *             the second parameter being the nominal time step.
+     * \param jobs The JobSystem used if the group is parallel, or nullptr.
+     */
+    template <typename F>
+    void processOnce(F&& run, JobSystem* jobs = nullptr)
+    {
+        scheduleAll_(period_);
+        runDue_(run, jobs);
+    }
+
+    /**
+     * \brief Gets the Systems of the group.
+     * 
+     * \return The handles of the Systems, in processing order.
+     */
+    std::vector<H> systems() const
+    {
+        std::vector<H> hs;
+        for (auto& m : members_)
+        { hs.push_back(m.h); }
+
+        return hs;
+    }
+
+private:
+    struct Member_
+    {
+        H h;
+
+        // Decides when an Interval System is due, starting staggered.
+        double acc;
+        Phase phase;
+        std::size_t seq;
+        double step = 0.0;
+        bool due = false;
+
+        // Time since the last call of an Interval System, its next step.
+        double elapsed = 0.0;
+    };
+
+    Timestep timestep_;
+    double period_;
+    std::size_t maxSteps_;
+    double acc_ = 0.0;
+    bool parallel_ = false;
+    std::vector<Member_> members_;
+    std::vector<std::pair<H, H>> edges_;
+    std::vector<std::vector<std::size_t>> waves_;
+    std::size_t nextSeq_ = 0;
+
+    auto find_(H h) const
+    {
+        return std::find_if(members_.begin(), members_.end(),
+                            [h](const auto& m) { return m.h == h; });
+    }
+
+    auto find_(H h)
+    {
+        return std::find_if(members_.begin(), members_.end(),
+                            [h](const auto& m) { return m.h == h; });
+    }
+
+    bool sort_()
+    {
+        // Ranks by phase then insertion order, so that a topological sort
+        // always picking the lowest ready rank gives a deterministic order.
+        auto ranked = members_;
+        std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+            return std::pair(a.phase, a.seq) < std::pair(b.phase, b.seq);
+        });
+
+        std::map<H, std::size_t> rank;
+        for (std::size_t i = 0; i < ranked.size(); i++)
+        { rank[ranked[i].h] = i; }
+
+        std::vector<std::vector<std::size_t>> next (ranked.size());
+        std::vector<std::size_t> preds (ranked.size(), 0);
+        for (auto [a, b] : edges_)
+        {
+            auto ra = rank[a], rb = rank[b];
+            if (ranked[ra].phase > ranked[rb].phase)
+            { return false; }
+
+            next[ra].push_back(rb);
+            preds[rb]++;
+        }
+
+        std::set<std::size_t> ready;
+        for (std::size_t i = 0; i < ranked.size(); i++)
+        {
+            if (preds[i] == 0)
+            { ready.insert(i); }
+        }
+
+        std::vector<Member_> sorted;
+        sorted.reserve(ranked.size());
+        while (!ready.empty())
+        {
+            auto i = *ready.begin();
+            ready.erase(ready.begin());
+            sorted.push_back(ranked[i]);
+            for (auto j : next[i])
+            {
+                if (--preds[j] == 0)
+                { ready.insert(j); }
+            }
+        }
+
+        if (sorted.size() != ranked.size())
+        { return false; }
+
+        members_ = std::move(sorted);
+        computeWaves_();
+        return true;
+    }
+
+    // Splits the sorted Systems into waves of Systems that can run
+    // concurrently: a System comes after the waves of its predecessors
+    // and of the previous phases.
+    void computeWaves_()
+    {
+        std::map<H, std::size_t> pos;
+        for (std::size_t i = 0; i < members_.size(); i++)
+        { pos[members_[i].h] = i; }
+
+        std::vector<std::vector<std::size_t>> preds (members_.size());
+        for (auto [a, b] : edges_)
+        { preds[pos[b]].push_back(pos[a]); }
+
+        waves_.clear();
+        std::vector<std::size_t> level (members_.size());
+        std::size_t phaseBase = 0;
+        for (std::size_t i = 0; i < members_.size(); i++)
+        {
+            if (i > 0 && members_[i].phase != members_[i - 1].phase)
+            { phaseBase = waves_.size(); }
+
+            level[i] = phaseBase;
+            for (auto p : preds[i])
+            { level[i] = std::max(level[i], level[p] + 1); }
+
+            if (level[i] >= waves_.size())
+            { waves_.resize(level[i] + 1); }
+
+            waves_[level[i]].push_back(i);
+        }
+    }
+
+    void scheduleAll_(double step)
+    {
+        for (auto& m : members_)
+        {
+            m.due = true;
+            m.step = step;
+            m.elapsed = 0.0;
+        }
+    }
+
+    template <typename F>
+    void runDue_(F& run, JobSystem* jobs)
+    {
+        if (!parallel_ || !jobs)
+        {
+            for (auto& m : members_)
+            {
+                if (m.due)
+                { run(m.h, m.step); }
+            }
+            return;
+        }
+
+        for (auto& wave : waves_)
+        {
+            jobs->parallelFor(0, wave.size(), 1, [&](std::size_t first, std::size_t last) {
+                for (auto i = first; i < last; i++)
+                {
+                    auto& m = members_[wave[i]];
+                    if (m.due)
+                    { run(m.h, m.step); }
+                }
+            });
+        }
+    }
+
+    // Initial accumulator of the seq-th inserted System. Successive Systems
+    // are spread over the period by the golden ratio, which leaves the
+    // accumulators of the other Systems untouched.
+    double stagger_(std::size_t seq) const
+    {
+        if (timestep_ != Timestep::Interval)
+        { return 0.0; }
+
+        auto f = double(seq) * 0.6180339887498949;
+        return period_ * (f - std::floor(f));
+    }
+};
+
+}
\ No newline at end of file
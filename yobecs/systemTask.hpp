@@ -0,0 +1,146 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Clock used to measure the time budgets of coroutine Systems.
+ */
+using TaskClock = std::chrono::steady_clock;
+
+/**
+ * \brief Represents a coroutine used as a System's process function. Such a
+ *        process can suspend itself with "co_await nextFrame()" or
+ *        "co_await budget(d)" and is resumed by the Model during the
+ *        following frames, until it returns.
+ */
+class SystemTask
+{
+public:
+    /**
+     * \brief Coroutine promise. Holds the deadlines of the current resume.
+     */
+    struct promise_type
+    {
+        TaskClock::time_point resumedAt;
+        TaskClock::time_point frameDeadline = TaskClock::time_point::max();
+        std::exception_ptr exception;
+
+        SystemTask get_return_object()
+        { return SystemTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+        std::suspend_always initial_suspend() noexcept
+        { return {}; }
+
+        std::suspend_always final_suspend() noexcept
+        { return {}; }
+
+        void return_void() {}
+
+        void unhandled_exception()
+        { exception = std::current_exception(); }
+    };
+
+    SystemTask() = default;
+
+    SystemTask(SystemTask&& o) noexcept
+    : h_ { std::exchange(o.h_, {}) }
+    {}
+
+    SystemTask& operator=(SystemTask&& o) noexcept
+    {
+        if (this != &o)
+        {
+            destroy_();
+            h_ = std::exchange(o.h_, {});
+        }
+
+        return *this;
+    }
+
+    ~SystemTask()
+    { destroy_(); }
+
+    /**
+     * \brief Checks if the coroutine holds a running process.
+     * 
+     * \return A boolean answering the check.
+     */
+    explicit operator bool() const
+    { return h_ && !h_.done(); }
+
+    /**
+     * \brief Resumes the coroutine until it suspends itself or returns.
+     *        Rethrows the exceptions escaping the coroutine.
+     * 
+     * \param frameDeadline Time after which any budget is exhausted.
+     */
+    void resume(TaskClock::time_point frameDeadline = TaskClock::time_point::max())
+    {
+        auto& p = h_.promise();
+        p.resumedAt = TaskClock::now();
+        p.frameDeadline = frameDeadline;
+        h_.resume();
+
+        if (p.exception)
+        { std::rethrow_exception(std::exchange(p.exception, nullptr)); }
+    }
+
+private:
+    std::coroutine_handle<promise_type> h_;
+
+    explicit SystemTask(std::coroutine_handle<promise_type> h)
+    : h_ { h }
+    {}
+
+    void destroy_()
+    {
+        if (h_)
+        { h_.destroy(); }
+    }
+};
+
+/**
+ * \brief Awaitable suspending a SystemTask until the next frame.
+ * 
+ * \return The awaitable.
+ */
+inline auto nextFrame()
+{ return std::suspend_always(); }
+
+/**
+ * \brief Awaitable suspending a SystemTask until the next frame if it ran
+ *        for more than d since it was resumed, or if the frame's budget is
+ *        exhausted. Otherwise it goes on without suspending.
+ * 
+ * \param d The time budget of the SystemTask per frame.
+ * 
+ * \return The awaitable.
+ */
+inline auto budget(TaskClock::duration d)
+{
+    struct Awaiter
+    {
+        TaskClock::duration d;
+
+        bool await_ready() const noexcept
+        { return false; }
+
+        bool await_suspend(std::coroutine_handle<SystemTask::promise_type> h) const
+        {
+            auto& p = h.promise();
+            auto now = TaskClock::now();
+            return now - p.resumedAt >= d || now >= p.frameDeadline;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    return Awaiter { d };
+}
+
+}
\ No newline at end of file
@@ -2,30 +2,55 @@
 
 #include <cstdint>
 #include <type_traits>
+#include <utility>
 
 namespace yobtk::utils {
 
 // indexVariadicTypePack
-// Based upon:
-// https://stackoverflow.com/questions/26169198/how-to-get-the-index-of-a-type-in-a-variadic-type-pack
+// Builds a table deriving from one leaf per (index, type) pair, then lets
+// deduction find the leaf of a type. Unlike a recursion over the pack, this
+// instantiates the table once per pack and a single function per lookup.
 
 using _indexVtp_t = std::size_t;
 
-template <typename T, typename ... Ts>
-struct _indexVtp;
+template <_indexVtp_t I, typename T>
+struct _indexVtpLeaf {};
 
-template <typename T, typename ... Ts>
-static constexpr auto _indexVtp_v = _indexVtp<T, Ts ...>::value;
+template <typename Is, typename ... Ts>
+struct _indexVtpTable;
 
-template <typename T, typename ... Ts>
-struct _indexVtp<T, T, Ts ...>
-: public std::integral_constant<_indexVtp_t, 0> {};
+template <_indexVtp_t ... Is, typename ... Ts>
+struct _indexVtpTable<std::index_sequence<Is ...>, Ts ...>
+: public _indexVtpLeaf<Is, Ts> ... {};
 
-template <typename T, typename U, typename ... Ts>
-struct _indexVtp<T, U, Ts ...>
-: public std::integral_constant<_indexVtp_t, 1 + _indexVtp_v<T, Ts ...>> {};
+template <typename T, _indexVtp_t I>
+constexpr _indexVtp_t _indexVtp(_indexVtpLeaf<I, T>)
+{ return I; }
 
 template <typename T, typename ... Ts>
-static constexpr auto indexVariadicTypePack = _indexVtp_v<T, Ts ...>;
+static constexpr auto indexVariadicTypePack = _indexVtp<T>(_indexVtpTable<std::index_sequence_for<Ts ...>, Ts ...>{});
+
+// FlatTuple
+// Derives directly from one leaf per element, where std::tuple chains its
+// bases, so that instantiating it and getting an element stay cheap for
+// large packs.
+
+template <_indexVtp_t I, typename T>
+struct _flatTupleLeaf
+{ [[no_unique_address]] T value; };
+
+template <typename Is, typename ... Ts>
+struct _flatTuple;
+
+template <_indexVtp_t ... Is, typename ... Ts>
+struct _flatTuple<std::index_sequence<Is ...>, Ts ...>
+: public _flatTupleLeaf<Is, Ts> ... {};
+
+template <typename ... Ts>
+using FlatTuple = _flatTuple<std::index_sequence_for<Ts ...>, Ts ...>;
+
+template <_indexVtp_t I, typename T>
+constexpr T& get(_flatTupleLeaf<I, T>& l)
+{ return l.value; }
 
 }
\ No newline at end of file
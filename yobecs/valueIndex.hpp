@@ -0,0 +1,151 @@
+#pragma once
+
+#include <map>
+#include <ranges>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Declares a value index on a Component's type. It is left undefined
+ *        by default, meaning that the type is not indexed. To index a type T,
+ *        specialise it with a static function "key(const T&)" returning the
+ *        indexed value (the whole value or a projection of one of its fields).
+ *        Adding "static constexpr bool sorted = true" makes the index ordered,
+ *        which allows range queries at the cost of logarithmic lookups.
+ * 
+ * \param T The Component's type.
+ */
+template <typename T>
+struct IndexTraits;
+
+/**
+ * \brief Checks if a Component's type declares a value index.
+ */
+template <typename T>
+concept Indexed = requires (const T& v) { IndexTraits<T>::key(v); };
+
+/**
+ * \brief Checks if a Component's type declares an ordered value index.
+ */
+template <typename T>
+concept SortedIndexed = Indexed<T> && requires {
+    requires IndexTraits<T>::sorted;
+};
+
+/**
+ * \brief Maps the indexed value of a Component's type to the entities
+ *        holding it.
+ * 
+ * \param T The Component's type. Must be Indexed.
+ * \param E The Entity type.
+ */
+template <typename T, typename E>
+class ValueIndex
+{
+public:
+    /**
+     * \brief Type of the indexed value.
+     */
+    using Key = std::remove_cvref_t<decltype(IndexTraits<T>::key(std::declval<const T&>()))>;
+
+    /**
+     * \brief Computes the key of a value.
+     * 
+     * \param val The value.
+     * 
+     * \return The key of the value.
+     */
+    static Key key(const T& val)
+    { return IndexTraits<T>::key(val); }
+
+    /**
+     * \brief Indexes the Entity e under key k.
+     * 
+     * \param k The key.
+     * \param e The entity.
+     */
+    void insert(const Key& k, E e)
+    { data_.emplace(k, e); }
+
+    /**
+     * \brief Removes the Entity e from key k.
+     * 
+     * \param k The key.
+     * \param e The entity.
+     */
+    void erase(const Key& k, E e)
+    {
+        auto [first, last] = data_.equal_range(k);
+        for (; first != last; first++)
+        {
+            if (first->second == e)
+            {
+                data_.erase(first);
+                return;
+            }
+        }
+    }
+
+    /**
+     * \brief Finds the entities indexed under key k.
+     * 
+     * \param k The key.
+     * 
+     * \return A view over the entities.
+     */
+    auto find(const Key& k)
+    {
+        auto [first, last] = data_.equal_range(k);
+        return view_(first, last);
+    }
+
+    /**
+     * \brief Finds the entities indexed under a key in [lo, hi).
+     * 
+     * \param lo The lower bound, included.
+     * \param hi The upper bound, excluded.
+     * 
+     * \return A view over the entities, ordered by key, empty if hi is not
+     *         greater than lo.
+     */
+    auto range(const Key& lo, const Key& hi) requires SortedIndexed<T>
+    {
+        auto first = data_.lower_bound(lo);
+        return view_(first, lo < hi ? data_.lower_bound(hi) : first);
+    }
+
+    /**
+     * \brief Finds the entities indexed under a key strictly lower than hi.
+     * 
+     * \param hi The upper bound, excluded.
+     * 
+     * \return A view over the entities, ordered by key.
+     */
+    auto below(const Key& hi) requires SortedIndexed<T>
+    { return view_(data_.begin(), data_.lower_bound(hi)); }
+
+    /**
+     * \brief Finds the entities indexed under a key lower or equal to hi.
+     * 
+     * \param hi The upper bound, included.
+     * 
+     * \return A view over the entities, ordered by key.
+     */
+    auto upTo(const Key& hi) requires SortedIndexed<T>
+    { return view_(data_.begin(), data_.upper_bound(hi)); }
+
+private:
+    using Data_ = std::conditional_t<SortedIndexed<T>,
+                                     std::multimap<Key, E>,
+                                     std::unordered_multimap<Key, E>>;
+
+    Data_ data_;
+
+    static auto view_(typename Data_::iterator first, typename Data_::iterator last)
+    { return std::ranges::subrange(first, last) | std::views::values; }
+};
+
+}
\ No newline at end of file
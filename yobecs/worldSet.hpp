@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "jobSystem.hpp"
+#include "wrappedHandle.hpp"
+
+namespace yobtk::ecs {
+
+/**
+ * \brief Represents a set of independent Models of the same type, for
+ *        instance the matches hosted by a server. Their Systems are processed
+ *        in parallel on a JobSystem shared by every Model of the set.
+ * 
+ * \param M The Models' type.
+ */
+template <typename M>
+class WorldSet
+{
+public:
+    /**
+     * \brief Represents a Model of the set for the user.
+     */
+    using WorldHandle = WrappedHandle<M*>;
+
+    /**
+     * \brief Time spent processing a Model.
+     */
+    struct Timing
+    {
+        std::chrono::steady_clock::duration last {};
+        std::chrono::steady_clock::duration total {};
+        std::size_t frames = 0;
+    };
+
+    /**
+     * \brief Creates an empty set.
+     * 
+     * \param jobs The JobSystem shared by the Models.
+     */
+    explicit WorldSet(std::shared_ptr<JobSystem> jobs = std::make_shared<JobSystem>())
+    : jobs_ { std::move(jobs) }
+    {}
+
+    /**
+     * \brief Creates a new Model in the set. Each Model is assigned a worker
+     *        of the JobSystem, which processes it preferably, so that its
+     *        data stays close to the same core from frame to frame.
+     * 
+     * \return A handle to the newly created Model.
+     */
+    WorldHandle create()
+    {
+        auto& w = worlds_.emplace_back(std::make_unique<World_>());
+        w->model.setJobSystem(jobs_);
+        w->worker = nextWorker_++;
+        return WorldHandle(&w->model);
+    }
+
+    /**
+     * \brief Creates a new Model in the set whose storage is placed on a
+     *        NUMA node, processed preferably by a worker of the same node
+     *        once the workers are pinned with "JobSystem::pinWorkers".
+     * 
+     * \param node The NUMA node.
+     * 
+     * \return A handle to the newly created Model.
+     */
+    WorldHandle create(int node)
+    {
+        auto h = create();
+        auto& w = *worlds_.back();
+        w.model.setPlacement(Placement::onNode(node));
+
+        std::vector<std::size_t> workers;
+        for (std::size_t i = 0; i < jobs_->workerCount(); i++)
+        {
+            if (jobs_->workerNode(i) == node)
+            { workers.push_back(i); }
+        }
+
+        if (!workers.empty())
+        { w.worker = workers[nodeWorlds_[node]++ % workers.size()]; }
+
+        return h;
+    }
+
+    /**
+     * \brief Removes a Model from the set. Must not be called during
+     *        "process".
+     * 
+     * \param hWorld A handle to the Model to be removed.
+     */
+    void remove(WorldHandle hWorld)
+    { std::erase_if(worlds_, [&](auto& w) { return &w->model == *hWorld; }); }
+
+    /**
+     * \brief Processes every Model for a frame lasting dt seconds, in
+     *        parallel. Returns once every Model is processed.
+     * 
+     * \param dt Elapsed time since the last frame, in seconds.
+     */
+    void process(double dt)
+    {
+        std::vector<JobSystem::JobHandle> hs;
+        hs.reserve(worlds_.size());
+        for (auto& w : worlds_)
+        {
+            hs.push_back(jobs_->submitTo(w->worker, [&w = *w, dt]() {
+                auto start = std::chrono::steady_clock::now();
+                w.model.process(dt);
+                w.timing.last = std::chrono::steady_clock::now() - start;
+                w.timing.total += w.timing.last;
+                w.timing.frames++;
+            }));
+        }
+
+        for (auto h : hs)
+        { jobs_->wait(h); }
+    }
+
+    /**
+     * \brief Gets the time spent processing a Model.
+     * 
+     * \param hWorld A handle to the Model of interest.
+     * 
+     * \return The timing of the last frame and of every frame.
+     */
+    const Timing& timing(WorldHandle hWorld) const
+    { return find_(hWorld).timing; }
+
+    /**
+     * \brief Gets the number of Models in the set.
+     * 
+     * \return The number of Models.
+     */
+    std::size_t size() const
+    { return worlds_.size(); }
+
+    /**
+     * \brief Retrieves the JobSystem shared by the Models.
+     * 
+     * \return A reference to the JobSystem.
+     */
+    JobSystem& jobs()
+    { return *jobs_; }
+
+private:
+    struct World_
+    {
+        M model;
+        Timing timing;
+        std::size_t worker;
+    };
+
+    std::shared_ptr<JobSystem> jobs_;
+    std::vector<std::unique_ptr<World_>> worlds_;
+    std::size_t nextWorker_ = 0;
+    std::map<int, std::size_t> nodeWorlds_;
+
+    const World_& find_(WorldHandle hWorld) const
+    {
+        return **std::find_if(worlds_.begin(), worlds_.end(),
+                              [&](auto& w) { return &w->model == *hWorld; });
+    }
+};
+
+}
\ No newline at end of file